@@ -0,0 +1,31 @@
+#
+# Try to find EGL library and include path.
+# Once done this will define
+#
+# EGL_FOUND
+# EGL_INCLUDE_PATH
+# EGL_LIBRARY
+#
+
+FIND_PATH( EGL_INCLUDE_PATH EGL/egl.h
+	/usr/include
+	/usr/local/include
+	/opt/local/include
+	DOC "The directory where EGL/egl.h resides")
+FIND_LIBRARY( EGL_LIBRARY
+	NAMES EGL
+	PATHS
+	/usr/lib64
+	/usr/lib
+	/usr/local/lib64
+	/usr/local/lib
+	/opt/local/lib
+	DOC "The EGL library")
+
+IF (EGL_INCLUDE_PATH AND EGL_LIBRARY)
+	SET( EGL_FOUND 1 CACHE STRING "Set to 1 if EGL is found, 0 otherwise")
+ELSE (EGL_INCLUDE_PATH AND EGL_LIBRARY)
+	SET( EGL_FOUND 0 CACHE STRING "Set to 1 if EGL is found, 0 otherwise")
+ENDIF (EGL_INCLUDE_PATH AND EGL_LIBRARY)
+
+MARK_AS_ADVANCED( EGL_FOUND )
@@ -0,0 +1,61 @@
+#ifndef LUMINOLGL_FRUSTUM_H
+#define LUMINOLGL_FRUSTUM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Geometry
+{
+    /**
+     * Axis-aligned bounding boxes stored as a structure of arrays (one array per coordinate of the centers
+     * and of the half extents), so that Frustum::cull can test several boxes per instruction.
+     */
+    struct AABBArray {
+        std::vector<float> centerX, centerY, centerZ;
+        std::vector<float> extentX, extentY, extentZ; /** half size of the box along each axis */
+
+        void resize(size_t count);
+
+        size_t size() const { return centerX.size(); }
+
+        /** Sets the box at index from its min and max corners */
+        void set(size_t index, const glm::vec3& AABBmin, const glm::vec3& AABBmax);
+
+        /** Box at index centered on center, extending by extent along each axis */
+        void set(size_t index, const glm::vec3& center, float extent);
+
+        void getBounds(size_t index, glm::vec3& AABBmin, glm::vec3& AABBmax) const;
+    };
+
+    /**
+     * The 6 clipping planes of a matrix (usually MVP): a point p is inside if -w <= x, y, z <= w for (x, y, z, w) = MVP * p.
+     * A box is kept if it is not entirely on the outer side of one of the planes. This is conservative:
+     * a box near a corner of the frustum may be kept even if it is outside, but a visible box is never rejected.
+     */
+    class Frustum {
+    private:
+        glm::vec4 _planes[6]; /** a, b, c, d: a * x + b * y + c * z + d >= 0 on the inner side (not normalized) */
+
+        bool isBoxVisible(const glm::vec3& center, const glm::vec3& extent) const;
+    public:
+        Frustum(const glm::mat4& MVP);
+
+        bool isVisible(const glm::vec3& AABBmin, const glm::vec3& AABBmax) const;
+
+        /** Tests all boxes, 4 per instruction. Bit i % 32 of visibilityMask[i / 32] is set if box i is visible,
+         *  visibilityMask is resized to the number of words needed. Returns the number of visible boxes
+         */
+        uint32_t cull(const AABBArray& boxes, std::vector<uint32_t>& visibilityMask) const;
+
+        /** Visibility of box i in a mask written by cull */
+        static bool isVisible(const std::vector<uint32_t>& visibilityMask, size_t i) {
+            return (visibilityMask[i / 32] >> (i % 32)) & 1u;
+        }
+    };
+}
+
+
+
+#endif //LUMINOLGL_FRUSTUM_H
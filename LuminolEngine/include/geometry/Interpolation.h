@@ -15,9 +15,13 @@ namespace Geometry
 
     float cosineInterpolation(float y1, float y2, float t);
 
+    /** Catmull-Rom cubic between y1 (t = 0) and y2 (t = 1), y0 and y3 give the tangents */
     float cubicInterpolation(float y0,float y1, float y2,float y3, float t);
 
     glm::vec3 cubicInterpolation(glm::vec3 v0,glm::vec3 v1, glm::vec3 v2,glm::vec3 v3, float t);
+
+    /** Weights of y0, y1, y2, y3 in cubicInterpolation at t (their sum is 1) */
+    void cubicInterpolationWeights(float t, float weights[4]);
 }
 
 
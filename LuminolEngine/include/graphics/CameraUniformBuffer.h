@@ -0,0 +1,69 @@
+#ifndef LUMINOLGL_CAMERAUNIFORMBUFFER_H
+#define LUMINOLGL_CAMERAUNIFORMBUFFER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "graphics/ShaderProgram.hpp"
+
+/**
+ * GLSL declaration of the camera block, matching CameraUniformBuffer::Block (std140).
+ * Member names are the UBO_keys ones. To be inserted after the #version line of the shaders reading it.
+ */
+#define CAMERA_UNIFORM_BLOCK_GLSL \
+    "layout(std140) uniform Camera {\n" \
+    "    mat4 Projection;\n" \
+    "    mat4 MV;\n" \
+    "    mat4 MVP;\n" \
+    "    mat4 MVNormal;\n" \
+    "    vec4 CamPos;\n" \
+    "    float Time;\n" \
+    "};\n"
+
+namespace Graphics
+{
+    /**
+     * Per-frame camera data shared by every program through the UBO_keys::STRUCT_BINDING_POINT_CAMERA
+     * uniform block, bound to a fixed binding point.
+     * The block is packed and uploaded once per frame by update(), programs only need to be bound once.
+     */
+    class CameraUniformBuffer {
+    public:
+        static const GLuint BINDING_POINT = 0;
+
+        /** std140 layout: only mat4 / vec4 members so the C++ struct has no padding to emulate */
+        struct Block {
+            glm::mat4 projection;
+            glm::mat4 view;
+            glm::mat4 viewProjection;
+            glm::mat4 viewNormal;
+            glm::vec4 cameraPosition;
+            float time;
+            float padding[3];
+        };
+
+    private:
+        GLuint _glId;
+        Block _block;
+
+    public:
+        CameraUniformBuffer();
+        ~CameraUniformBuffer();
+
+        CameraUniformBuffer(const CameraUniformBuffer&) = delete;
+        CameraUniformBuffer& operator=(const CameraUniformBuffer&) = delete;
+
+        /** Packs the block (model matrix is identity) and uploads it in one buffer update */
+        void update(const glm::mat4 &projection, const glm::mat4 &view, float time = 0);
+
+        /** Binds the buffer to BINDING_POINT, to call again if another buffer was bound there */
+        void bind() const;
+
+        const Block& block() const;
+
+        /** Binds the Camera block of a program to BINDING_POINT (no-op if the program has no such block) */
+        static void bindProgram(GLuint programId);
+        static void bindProgram(ShaderProgram &program);
+    };
+}
+
+#endif //LUMINOLGL_CAMERAUNIFORMBUFFER_H
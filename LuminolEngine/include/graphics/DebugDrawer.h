@@ -6,6 +6,7 @@
 #define LUMINOLGL_DEBUGRAY_H
 
 #include <vector>
+#include <map>
 #include "graphics/VertexBufferObject.h"
 #include "graphics/VertexArrayObject.h"
 #include "graphics/ShaderProgram.hpp"
@@ -16,12 +17,29 @@ namespace Graphics
     class DebugDrawer {
         /**
          * Small helper class for scene debugging.
+         * draw* calls only record primitives (with per-vertex color) in CPU side batches,
+         * everything is uploaded and drawn by flush(), once per frame.
          */
+        struct Batch {
+            std::vector<glm::vec3> positions;
+            std::vector<glm::vec3> colors;
+
+            void add(const glm::vec3 &position, const glm::vec3 &color);
+        };
+
         VertexArrayObject _VAO;
         VertexBufferObject _verticesVBO;
-        VertexBufferObject _indexesVBO;
+        VertexBufferObject _colorsVBO;
         VertexBufferObject _transformVBO;
-        std::vector<glm::vec3> _points;
+
+        /** Lines and points are batched by width / size since they are fixed state per draw */
+        std::map<float, Batch> _lines;
+        std::map<float, Batch> _points;
+        Batch _triangles;
+
+        /** Flattened batches, kept between frames to avoid reallocations */
+        std::vector<glm::vec3> _vertices;
+        std::vector<glm::vec3> _colors;
 
         static DebugDrawer _drawer;
 
@@ -30,15 +48,28 @@ namespace Graphics
 
         DebugDrawer();
     public:
-        static void drawRay(const glm::vec3 &point1, const glm::vec3 &point2, ShaderProgram &program, const glm::vec3 &color = glm::vec3(1, 1, 1), float lineWidth = 1);
-        static void drawTriangle(const glm::vec3 &point1, const glm::vec3 &point2, const glm::vec3 &point3, ShaderProgram &program, const glm::vec3 &color = glm::vec3(1, 1, 1));
-        static void drawPyramid(const glm::mat4 &trans, ShaderProgram &program, float scale = 1, const glm::vec3 &color = glm::vec3(1, 1, 1));
-        static void drawCube(const glm::mat4 &trans, ShaderProgram &program, float scale = 1, const glm::vec3 &color = glm::vec3(1, 1, 1));
-        static void drawPoint(const glm::vec3 &point, ShaderProgram &program, const glm::vec3 &color = glm::vec3(1, 1, 1), float pointSize = 1);
-        static void drawAxis(const glm::mat4 &trans, ShaderProgram &program, float scale = 1, float lineWidth = 1);
-        static void drawTranslateAxis(const glm::mat4 &trans, ShaderProgram &program, float scale = 1, float lineWidth = 1);
-        static void drawScaleAxis(const glm::mat4 &trans, ShaderProgram &program, float scale = 1, float lineWidth = 1);
-        static void drawRotationAxis(const glm::mat4 &trans, ShaderProgram &program, float scale = 1, float lineWidth = 1);
+        static void drawRay(const glm::vec3 &point1, const glm::vec3 &point2, const glm::vec3 &color = glm::vec3(1, 1, 1), float lineWidth = 1);
+        static void drawRay(const glm::vec3 &point1, const glm::vec3 &point2, const glm::vec3 &color1, const glm::vec3 &color2, float lineWidth = 1);
+        static void drawTriangle(const glm::vec3 &point1, const glm::vec3 &point2, const glm::vec3 &point3, const glm::vec3 &color = glm::vec3(1, 1, 1));
+        static void drawTriangle(const glm::vec3 &point1, const glm::vec3 &point2, const glm::vec3 &point3,
+                                 const glm::vec3 &color1, const glm::vec3 &color2, const glm::vec3 &color3);
+        static void drawPyramid(const glm::mat4 &trans, float scale = 1, const glm::vec3 &color = glm::vec3(1, 1, 1));
+        static void drawCube(const glm::mat4 &trans, float scale = 1, const glm::vec3 &color = glm::vec3(1, 1, 1));
+        /** Wireframe axis aligned box */
+        static void drawBox(const glm::vec3 &center, const glm::vec3 &dimension, const glm::vec3 &color = glm::vec3(1, 1, 1), float lineWidth = 1);
+        static void drawPoint(const glm::vec3 &point, const glm::vec3 &color = glm::vec3(1, 1, 1), float pointSize = 1);
+        static void drawAxis(const glm::mat4 &trans, float scale = 1, float lineWidth = 1);
+        static void drawTranslateAxis(const glm::mat4 &trans, float scale = 1, float lineWidth = 1);
+        static void drawScaleAxis(const glm::mat4 &trans, float scale = 1, float lineWidth = 1);
+        static void drawRotationAxis(const glm::mat4 &trans, float scale = 1, float lineWidth = 1);
+
+        /**
+         * Uploads every primitive recorded since the last flush in one buffer update and draws them
+         * with the given program (one draw call per primitive type and line width / point size).
+         * Point sizes are set through the program's PointSize uniform (written to gl_PointSize).
+         * Batches are emptied.
+         */
+        static void flush(ShaderProgram &program);
     };
 }
 
@@ -0,0 +1,40 @@
+#ifndef LUMINOLGL_PROGRAMBINARYCACHE_H
+#define LUMINOLGL_PROGRAMBINARYCACHE_H
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+namespace Graphics
+{
+    /**
+     * On disk cache of linked programs (glGetProgramBinary / glProgramBinary).
+     * Entries are keyed by a hash of the shader sources and of the driver string (vendor, renderer, version),
+     * so a program is only compiled again when one of its sources or the driver changes.
+     * Needs GL 4.1 or ARB_get_program_binary, otherwise load() always misses and store() does nothing.
+     */
+    class ProgramBinaryCache {
+        static std::string _directory;
+
+        static bool isSupported();
+        static std::string path(const std::string &key);
+    public:
+        /** Key of a program from the sources of its stages, in attachment order */
+        static std::string key(const std::vector<std::string> &sources);
+
+        /** Linked program loaded from the cache, 0 if there is no valid entry for this key */
+        static GLuint load(const std::string &key);
+
+        /** To call before glLinkProgram on a program that will be stored */
+        static void prepare(GLuint programId);
+
+        /** Stores the binary of a successfully linked program */
+        static void store(const std::string &key, GLuint programId);
+
+        /** Cache directory ($XDG_CACHE_HOME/partykel, or ~/.cache/partykel, by default), an empty path disables the cache */
+        static void setDirectory(const std::string &directory);
+        static const std::string& directory();
+    };
+}
+
+#endif //LUMINOLGL_PROGRAMBINARYCACHE_H
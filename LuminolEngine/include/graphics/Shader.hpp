@@ -8,17 +8,23 @@ namespace Graphics{
 
     /**
      * Shader OpenGL wrapper.
+     * The source is read at construction but only compiled when a ShaderProgram needs it
+     * (not at all if the program is found in the ProgramBinaryCache).
      */
     class Shader{
         GLuint _idShader;
         GLenum _type;
         std::string _path;
+        std::string _source;
+        void load();
     public:
         Shader(GLenum type, const std::string& path);
         ~Shader();
 
         std::string getPath() const;
         GLuint id() const;
+        const std::string& source() const;
+        bool isCompiled() const;
         void compile();
         void checkCompile() const;
         void changeProperties(GLenum type, const std::string& path);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "graphics/Shader.hpp"
+#include "graphics/UniformHandle.hpp"
 #include <GL/gl.h>
 #include <glm/vec3.hpp>
 #include <glm/vec2.hpp>
@@ -9,12 +10,15 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <unordered_map>
 
 namespace Graphics{
 
     /**
      * Shader Program wrapper.
      * In order to prevent delete side effects of shared shader between ShaderProgram, each shader is a shared_ptr.
+     * Uniform locations are cached at link time: updateUniform does not query the driver, and uniform<T>()
+     * returns a typed handle for callers that update the same uniform every frame.
      */
 
     class ShaderProgram {
@@ -22,8 +26,10 @@ namespace Graphics{
         std::shared_ptr<Shader> _vertexShader;
         std::shared_ptr<Shader> _geometryShader;
         std::shared_ptr<Shader> _fragShader;
+        std::unordered_map<std::string, GLint> _uniformLocations;
         void compile();
         void checkLinkErrors() const;
+        void cacheUniformLocations();
 
     public:
         ShaderProgram(const std::string& vShader, const std::string& gShader, const std::string& fShader);
@@ -37,6 +43,14 @@ namespace Graphics{
         const std::shared_ptr<Shader> gShader() const;
         const std::shared_ptr<Shader> fShader() const;
 
+        /** Location of an active uniform, -1 if the program has no such active uniform */
+        GLint uniformLocation(const std::string& uniformName) const;
+
+        template <typename T>
+        UniformHandle<T> uniform(const std::string& uniformName) const {
+            return UniformHandle<T>(_programId, uniformLocation(uniformName));
+        }
+
         void updateUniform(const std::string& uniformName, float v);
         void updateUniform(const std::string& uniformName, int v);
         void updateUniform(const std::string& uniformName, const glm::ivec2 & v);
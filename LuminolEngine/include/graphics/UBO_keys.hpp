@@ -21,6 +21,7 @@ namespace Graphics{
         const std::string MV                            = "MV";
         const std::string MV_NORMAL                     = "MVNormal";
         const std::string MV_INVERSE                    = "MVInverse";
+        const std::string PROJECTION                    = "Projection";
         const std::string TIME                          = "Time";
         const std::string SPECULAR_POWER                = "SpecularPower";
 
@@ -70,6 +71,7 @@ namespace Graphics{
 
         // DEBUG
         const std::string DEBUG_COLOR                   = "debugColor";
+        const std::string DEBUG_POINT_SIZE              = "PointSize";
 
 
         // UBO STRUCTS BINDING POINTS
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <vector>
+
+namespace Graphics{
+
+    /**
+     * glProgramUniform* overloads used by UniformHandle, one per supported uniform type.
+     */
+    inline void programUniform(GLuint program, GLint location, float v)              { glProgramUniform1f(program, location, v); }
+    inline void programUniform(GLuint program, GLint location, int v)                { glProgramUniform1i(program, location, v); }
+    inline void programUniform(GLuint program, GLint location, const glm::ivec2& v)  { glProgramUniform2iv(program, location, 1, glm::value_ptr(v)); }
+    inline void programUniform(GLuint program, GLint location, const glm::vec2& v)   { glProgramUniform2fv(program, location, 1, glm::value_ptr(v)); }
+    inline void programUniform(GLuint program, GLint location, const glm::vec3& v)   { glProgramUniform3fv(program, location, 1, glm::value_ptr(v)); }
+    inline void programUniform(GLuint program, GLint location, const glm::mat3& v)   { glProgramUniformMatrix3fv(program, location, 1, 0, glm::value_ptr(v)); }
+    inline void programUniform(GLuint program, GLint location, const glm::mat4& v)   { glProgramUniformMatrix4fv(program, location, 1, 0, glm::value_ptr(v)); }
+    inline void programUniform(GLuint program, GLint location, const std::vector<glm::vec3>& v) {
+        glProgramUniform3fv(program, location, v.size(), (const float*)v.data());
+    }
+
+    /**
+     * Uniform of a ShaderProgram resolved once (see ShaderProgram::uniform<T>), then set without any name lookup.
+     * A handle on an inactive or unknown uniform has location -1: set() is then a no-op, like glUniform* with -1.
+     */
+    template <typename T>
+    class UniformHandle {
+        GLuint _programId;
+        GLint _location;
+    public:
+        UniformHandle(): _programId(0), _location(-1) {}
+        UniformHandle(GLuint programId, GLint location): _programId(programId), _location(location) {}
+
+        void set(const T& v) const { programUniform(_programId, _location, v); }
+
+        GLint location() const { return _location; }
+        bool isValid() const { return _location != -1; }
+    };
+}
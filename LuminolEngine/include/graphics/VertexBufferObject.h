@@ -20,9 +20,22 @@ namespace Graphics
         INT,
         ELEMENT_ARRAY_BUFFER,
         INSTANCE_BUFFER,                /** to store instance position or rotation or whatever you want */
+        INSTANCE_FLOAT_BUFFER,          /** to store one float per instance (scale, ...) */
         INSTANCE_TRANSFORMATION_BUFFER  /** to store transformations matrix */
     };
 
+    /**
+     * How often the data is updated, gives the GL usage hint and the update strategy:
+     * STATIC  exact size allocation, for data set once
+     * DYNAMIC geometric growth, updates with glBufferSubData when the data fits
+     * STREAM  geometric growth, updates through an invalidated mapped range (no wait on previous draws)
+     */
+    enum BufferUsage{
+        STATIC,
+        DYNAMIC,
+        STREAM
+    };
+
     class VertexBufferObject {
     private:
         GLuint _glId;
@@ -30,15 +43,21 @@ namespace Graphics
         GLenum _target;
         GLuint _attribArray;
         bool _isInGPU;
+        BufferUsage _usage;
+        GLsizeiptr _capacity;   /** allocated bytes */
+        GLsizeiptr _size;       /** bytes of the last updateData */
+        void upload(const void* data, GLsizeiptr size);
+        void uploadRange(const void* data, GLintptr offset, GLsizeiptr size);
         void initVboVertexDescriptor();
         void initVboVec3();
         void initVboVec2();
         void initVboFloat();
         void initVboInt();
         void initVboInstanceVec3();
+        void initVboInstanceFloat();
         void initVboInstanceMat4();
     public:
-        VertexBufferObject(DataType dataType, GLuint attribArray = 0, bool initGL = true);
+        VertexBufferObject(DataType dataType, GLuint attribArray = 0, bool initGL = true, BufferUsage usage = STATIC);
         VertexBufferObject(VertexBufferObject&& other);
         VertexBufferObject(const VertexBufferObject& other);
         ~VertexBufferObject();
@@ -55,7 +74,21 @@ namespace Graphics
         void updateData(const std::vector<float>& data);
         void updateData(const std::vector<int>& data);
         void updateData(const std::vector<glm::mat4>& data);
+
+        /**
+         * Uploads only the elements [first, first + count) of data, at the same place in the buffer.
+         * The buffer must already hold them (previous updateData with at least first + count elements).
+         */
+        template <typename T>
+        void updateSubData(const std::vector<T>& data, size_t first, size_t count){
+            uploadRange(data.data() + first, first * sizeof(T), count * sizeof(T));
+        }
+
         void setAttribArray(GLuint value);
+        void setUsage(BufferUsage usage);
+        BufferUsage usage() const;
+        GLsizeiptr capacity() const;
+        GLsizeiptr size() const;
         static void unbindAll();
     };
 }
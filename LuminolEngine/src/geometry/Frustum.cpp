@@ -0,0 +1,129 @@
+#include <cmath>
+#include <cstring>
+#include "geometry/Frustum.h"
+
+namespace Geometry
+{
+    void AABBArray::resize(size_t count) {
+        centerX.resize(count);
+        centerY.resize(count);
+        centerZ.resize(count);
+        extentX.resize(count);
+        extentY.resize(count);
+        extentZ.resize(count);
+    }
+
+    void AABBArray::set(size_t index, const glm::vec3 &AABBmin, const glm::vec3 &AABBmax) {
+        glm::vec3 center = 0.5f * (AABBmin + AABBmax);
+        glm::vec3 extent = 0.5f * (AABBmax - AABBmin);
+        centerX[index] = center.x;
+        centerY[index] = center.y;
+        centerZ[index] = center.z;
+        extentX[index] = extent.x;
+        extentY[index] = extent.y;
+        extentZ[index] = extent.z;
+    }
+
+    void AABBArray::set(size_t index, const glm::vec3 &center, float extent) {
+        centerX[index] = center.x;
+        centerY[index] = center.y;
+        centerZ[index] = center.z;
+        extentX[index] = extentY[index] = extentZ[index] = extent;
+    }
+
+    void AABBArray::getBounds(size_t index, glm::vec3 &AABBmin, glm::vec3 &AABBmax) const {
+        glm::vec3 center(centerX[index], centerY[index], centerZ[index]);
+        glm::vec3 extent(extentX[index], extentY[index], extentZ[index]);
+        AABBmin = center - extent;
+        AABBmax = center + extent;
+    }
+
+    Frustum::Frustum(const glm::mat4 &MVP) {
+        // Rows of the matrix (glm is column major): clip coordinate c of p is dot(row[c], p)
+        glm::vec4 row[4];
+        for(int c = 0; c < 4; ++c)
+            row[c] = glm::vec4(MVP[0][c], MVP[1][c], MVP[2][c], MVP[3][c]);
+
+        // -w <= x <= w, -w <= y <= w, -w <= z <= w
+        for(int c = 0; c < 3; ++c) {
+            _planes[2 * c] = row[3] + row[c];
+            _planes[2 * c + 1] = row[3] - row[c];
+        }
+    }
+
+    bool Frustum::isVisible(const glm::vec3 &AABBmin, const glm::vec3 &AABBmax) const {
+        return isBoxVisible(0.5f * (AABBmin + AABBmax), 0.5f * (AABBmax - AABBmin));
+    }
+
+    bool Frustum::isBoxVisible(const glm::vec3 &center, const glm::vec3 &extent) const {
+        for(auto& plane : _planes) {
+            // Distance of the center and projection of the half extents on the normal of the plane
+            float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+            float radius = std::abs(plane.x) * extent.x + std::abs(plane.y) * extent.y + std::abs(plane.z) * extent.z;
+            if(distance + radius < 0)
+                return false;
+        }
+        return true;
+    }
+
+    namespace {
+        // 4 floats per instruction (GCC/Clang vector extension: SSE on x86, NEON on ARM)
+        typedef float float4 __attribute__((vector_size(16)));
+        typedef int32_t int4 __attribute__((vector_size(16)));
+
+        inline float4 load(const float* p) { float4 v; std::memcpy(&v, p, sizeof(v)); return v; }
+        inline float4 splat(float x) { float4 v = {x, x, x, x}; return v; }
+    }
+
+    uint32_t Frustum::cull(const AABBArray &boxes, std::vector<uint32_t> &visibilityMask) const {
+        size_t count = boxes.size();
+        visibilityMask.assign((count + 31) / 32, 0u);
+
+        // Coefficients broadcast once for all the boxes
+        float4 a[6], b[6], c[6], d[6], absA[6], absB[6], absC[6];
+        for(int p = 0; p < 6; ++p) {
+            a[p] = splat(_planes[p].x);
+            b[p] = splat(_planes[p].y);
+            c[p] = splat(_planes[p].z);
+            d[p] = splat(_planes[p].w);
+            absA[p] = splat(std::abs(_planes[p].x));
+            absB[p] = splat(std::abs(_planes[p].y));
+            absC[p] = splat(std::abs(_planes[p].z));
+        }
+        const float4 zero = splat(0.f);
+
+        uint32_t visibleCount = 0;
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4) {
+            float4 cx = load(&boxes.centerX[i]), cy = load(&boxes.centerY[i]), cz = load(&boxes.centerZ[i]);
+            float4 ex = load(&boxes.extentX[i]), ey = load(&boxes.extentY[i]), ez = load(&boxes.extentZ[i]);
+
+            int4 outside = zero != zero;
+            for(int p = 0; p < 6; ++p) {
+                float4 distance = a[p] * cx + b[p] * cy + c[p] * cz + d[p];
+                float4 radius = absA[p] * ex + absB[p] * ey + absC[p] * ez;
+                outside |= distance + radius < zero;
+            }
+
+            // 4 boxes never straddle two words of the mask
+            uint32_t bits = 0;
+            for(int lane = 0; lane < 4; ++lane) {
+                if(!outside[lane]) {
+                    bits |= 1u << lane;
+                    ++visibleCount;
+                }
+            }
+            visibilityMask[i / 32] |= bits << (i % 32);
+        }
+
+        for(; i < count; ++i) {
+            glm::vec3 center(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]);
+            glm::vec3 extent(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+            if(isBoxVisible(center, extent)) {
+                visibilityMask[i / 32] |= 1u << (i % 32);
+                ++visibleCount;
+            }
+        }
+        return visibleCount;
+    }
+}
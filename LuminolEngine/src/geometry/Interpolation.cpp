@@ -0,0 +1,39 @@
+#include <cmath>
+#include "geometry/Interpolation.h"
+
+namespace Geometry
+{
+    float linearInterpolation(float y1, float y2, float t) {
+        return y1 * (1 - t) + y2 * t;
+    }
+
+    glm::vec3 linearInterpolation(glm::vec3 v1, glm::vec3 v2, float t) {
+        return v1 * (1 - t) + v2 * t;
+    }
+
+    float cosineInterpolation(float y1, float y2, float t) {
+        float t2 = (1 - std::cos(t * 3.14159265f)) / 2;
+        return linearInterpolation(y1, y2, t2);
+    }
+
+    void cubicInterpolationWeights(float t, float weights[4]) {
+        float t2 = t * t;
+        float t3 = t2 * t;
+        weights[0] = 0.5f * (-t3 + 2 * t2 - t);
+        weights[1] = 0.5f * (3 * t3 - 5 * t2 + 2);
+        weights[2] = 0.5f * (-3 * t3 + 4 * t2 + t);
+        weights[3] = 0.5f * (t3 - t2);
+    }
+
+    float cubicInterpolation(float y0, float y1, float y2, float y3, float t) {
+        float w[4];
+        cubicInterpolationWeights(t, w);
+        return w[0] * y0 + w[1] * y1 + w[2] * y2 + w[3] * y3;
+    }
+
+    glm::vec3 cubicInterpolation(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2, glm::vec3 v3, float t) {
+        float w[4];
+        cubicInterpolationWeights(t, w);
+        return w[0] * v0 + w[1] * v1 + w[2] * v2 + w[3] * v3;
+    }
+}
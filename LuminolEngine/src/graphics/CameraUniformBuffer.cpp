@@ -0,0 +1,57 @@
+#include "graphics/CameraUniformBuffer.h"
+#include "graphics/UBO_keys.hpp"
+#include <glog/logging.h>
+
+namespace Graphics
+{
+    CameraUniformBuffer::CameraUniformBuffer() : _block() {
+        glGenBuffers(1, &_glId);
+        glBindBuffer(GL_UNIFORM_BUFFER, _glId);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        bind();
+    }
+
+    CameraUniformBuffer::~CameraUniformBuffer() {
+        glDeleteBuffers(1, &_glId);
+        _glId = 0;
+    }
+
+    void CameraUniformBuffer::update(const glm::mat4 &projection, const glm::mat4 &view, float time) {
+        _block.projection = projection;
+        _block.view = view;
+        _block.viewProjection = projection * view;
+        _block.viewNormal = glm::transpose(glm::inverse(view));
+        _block.cameraPosition = glm::inverse(view) * glm::vec4(0, 0, 0, 1);
+        _block.time = time;
+
+        glBindBuffer(GL_UNIFORM_BUFFER, _glId);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &_block);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void CameraUniformBuffer::bind() const {
+        glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, _glId);
+    }
+
+    const CameraUniformBuffer::Block& CameraUniformBuffer::block() const {
+        return _block;
+    }
+
+    void CameraUniformBuffer::bindProgram(GLuint programId) {
+        GLuint blockIndex = glGetUniformBlockIndex(programId, UBO_keys::STRUCT_BINDING_POINT_CAMERA.c_str());
+        if(blockIndex == GL_INVALID_INDEX)
+            return;
+
+        GLint blockSize;
+        glGetActiveUniformBlockiv(programId, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
+        DLOG_IF(WARNING, blockSize > GLint(sizeof(Block))) << "Camera block of program " << programId << " is larger than CameraUniformBuffer::Block";
+
+        glUniformBlockBinding(programId, blockIndex, BINDING_POINT);
+    }
+
+    void CameraUniformBuffer::bindProgram(ShaderProgram &program) {
+        bindProgram(program.id());
+    }
+}
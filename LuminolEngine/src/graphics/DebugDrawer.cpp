@@ -3,8 +3,8 @@
 //
 
 #include "graphics/DebugDrawer.h"
+#include "graphics/UBO_keys.hpp"
 #include <glog/logging.h>
-#include <graphics/UBO_keys.hpp>
 #include <glm/gtx/transform.hpp>
 
 namespace Graphics
@@ -12,18 +12,21 @@ namespace Graphics
     bool DebugDrawer::_isInit = false;
     DebugDrawer DebugDrawer::_drawer;
 
+    void DebugDrawer::Batch::add(const glm::vec3 &position, const glm::vec3 &color) {
+        positions.push_back(position);
+        colors.push_back(color);
+    }
+
     void DebugDrawer::init() {
         if(_isInit) return;
         _isInit = true;
 
         _drawer._VAO.addVBO(&_drawer._verticesVBO);
-        _drawer._VAO.addVBO(&_drawer._indexesVBO);
+        _drawer._VAO.addVBO(&_drawer._colorsVBO);
         _drawer._VAO.addVBO(&_drawer._transformVBO);
         _drawer._VAO.init();
-        std::vector<int> ids = {0,1,2};
         std::vector<glm::mat4> trans = {glm::mat4()};
 
-        _drawer._indexesVBO.updateData(ids);
         _drawer._transformVBO.updateData(trans);
 
         Graphics::VertexArrayObject::unbindAll();
@@ -32,62 +35,37 @@ namespace Graphics
 
     DebugDrawer::DebugDrawer() :
             _VAO(false),
-            _verticesVBO(Graphics::VEC3, 0, false),
-            _indexesVBO(Graphics::ELEMENT_ARRAY_BUFFER, 0, false),
+            _verticesVBO(Graphics::VEC3, 0, false, Graphics::STREAM),
+            _colorsVBO(Graphics::VEC3, 5, false, Graphics::STREAM),
             _transformVBO(Graphics::INSTANCE_TRANSFORMATION_BUFFER, 1, false)
     { }
 
-    void DebugDrawer::drawRay(const glm::vec3 &point1, const glm::vec3 &point2, ShaderProgram &program, const glm::vec3 &color, float lineWidth) {
-        if(!_isInit) init();
-
-        _drawer._points.clear();
-        _drawer._points.push_back(point1);
-        _drawer._points.push_back(point2);
-        _drawer._verticesVBO.updateData(_drawer._points);
-
-        program.useProgram();
-        program.updateUniform(UBO_keys::DEBUG_COLOR, color);
-
-        glLineWidth(lineWidth);
-
-        _drawer._VAO.bind();
-        glDrawElements(GL_LINES, 2, GL_UNSIGNED_INT, (void*)0);
+    void DebugDrawer::drawRay(const glm::vec3 &point1, const glm::vec3 &point2, const glm::vec3 &color, float lineWidth) {
+        drawRay(point1, point2, color, color, lineWidth);
     }
 
-    void DebugDrawer::drawTriangle(const glm::vec3 &point1, const glm::vec3 &point2, const glm::vec3 &point3, ShaderProgram &program, const glm::vec3 &color) {
-        if(!_isInit) init();
-
-        _drawer._points.clear();
-        _drawer._points.push_back(point1);
-        _drawer._points.push_back(point2);
-        _drawer._points.push_back(point3);
-        _drawer._verticesVBO.updateData(_drawer._points);
-
-        program.useProgram();
-        program.updateUniform(UBO_keys::DEBUG_COLOR, color);
-
-        _drawer._VAO.bind();
-        glDrawElements(GL_TRIANGLE_STRIP, 3, GL_UNSIGNED_INT, (void*)0);
+    void DebugDrawer::drawRay(const glm::vec3 &point1, const glm::vec3 &point2, const glm::vec3 &color1, const glm::vec3 &color2, float lineWidth) {
+        Batch& batch = _drawer._lines[lineWidth];
+        batch.add(point1, color1);
+        batch.add(point2, color2);
     }
 
-    void DebugDrawer::drawPoint(const glm::vec3 &point, ShaderProgram &program, const glm::vec3 &color, float pointSize) {
-        if(!_isInit) init();
-
-        glPointSize(pointSize);
-
-        _drawer._points.clear();
-        _drawer._points.push_back(point);
-        _drawer._verticesVBO.updateData(_drawer._points);
+    void DebugDrawer::drawTriangle(const glm::vec3 &point1, const glm::vec3 &point2, const glm::vec3 &point3, const glm::vec3 &color) {
+        drawTriangle(point1, point2, point3, color, color, color);
+    }
 
-        program.useProgram();
-        program.updateUniform(UBO_keys::DEBUG_COLOR, color);
-        _drawer._VAO.bind();
-        glDrawElements(GL_POINTS, 1, GL_UNSIGNED_INT, (void*)0);
+    void DebugDrawer::drawTriangle(const glm::vec3 &point1, const glm::vec3 &point2, const glm::vec3 &point3,
+                                   const glm::vec3 &color1, const glm::vec3 &color2, const glm::vec3 &color3) {
+        _drawer._triangles.add(point1, color1);
+        _drawer._triangles.add(point2, color2);
+        _drawer._triangles.add(point3, color3);
     }
 
-    void DebugDrawer::drawPyramid(const glm::mat4 &trans, ShaderProgram &program, float scale, const glm::vec3 &color) {
-        if(!_isInit) init();
+    void DebugDrawer::drawPoint(const glm::vec3 &point, const glm::vec3 &color, float pointSize) {
+        _drawer._points[pointSize].add(point, color);
+    }
 
+    void DebugDrawer::drawPyramid(const glm::mat4 &trans, float scale, const glm::vec3 &color) {
         glm::vec3 xAxis = glm::vec3(trans * glm::vec4(1,0,0,0));
         glm::vec3 yAxis = glm::vec3(trans * glm::vec4(0,1,0,0));
         glm::vec3 zAxis = glm::vec3(trans * glm::vec4(0,0,1,0));
@@ -104,28 +82,26 @@ namespace Graphics
         drawTriangle(origin + scale * yAxis + pyramid[0],
                      origin + scale * yAxis + pyramid[1],
                      origin + scale * yAxis + pyramid[2],
-                     program, color);
+                     color);
 
         drawTriangle(origin + scale * yAxis + pyramid[0],
                      origin + scale * yAxis + pyramid[2],
                      origin + scale * yAxis + pyramid[3],
-                     program, color);
+                     color);
 
         drawTriangle(origin + scale * yAxis + pyramid[0],
                      origin + scale * yAxis + pyramid[3],
                      origin + scale * yAxis + pyramid[4],
-                     program, color);
+                     color);
 
         drawTriangle(origin + scale * yAxis + pyramid[0],
                      origin + scale * yAxis + pyramid[4],
                      origin + scale * yAxis + pyramid[1],
-                     program, color);
+                     color);
     }
 
 
-    void DebugDrawer::drawCube(const glm::mat4 &trans, ShaderProgram &program, float scale, const glm::vec3 &color) {
-        if(!_isInit) init();
-
+    void DebugDrawer::drawCube(const glm::mat4 &trans, float scale, const glm::vec3 &color) {
         std::vector<glm::vec3> cube;
 
         glm::vec3 origin = glm::vec3(trans *  glm::vec4(0,0,0,1));
@@ -138,62 +114,151 @@ namespace Graphics
         cube.push_back(origin + glm::vec3(-scale,-scale,-scale));
         cube.push_back(origin + glm::vec3(+scale,-scale,-scale));
 
-        drawTriangle(cube[0], cube[1], cube[2], program, color);
-        drawTriangle(cube[0], cube[2], cube[5], program, color);
+        drawTriangle(cube[0], cube[1], cube[2], color);
+        drawTriangle(cube[0], cube[2], cube[5], color);
 
-        drawTriangle(cube[1], cube[2], cube[3], program, color);
-        drawTriangle(cube[1], cube[3], cube[6], program, color);
+        drawTriangle(cube[1], cube[2], cube[3], color);
+        drawTriangle(cube[1], cube[3], cube[6], color);
 
-        drawTriangle(cube[3], cube[4], cube[6], program, color);
-        drawTriangle(cube[6], cube[4], cube[7], program, color);
+        drawTriangle(cube[3], cube[4], cube[6], color);
+        drawTriangle(cube[6], cube[4], cube[7], color);
 
-        drawTriangle(cube[0], cube[5], cube[4], program, color);
-        drawTriangle(cube[0], cube[4], cube[7], program, color);
+        drawTriangle(cube[0], cube[5], cube[4], color);
+        drawTriangle(cube[0], cube[4], cube[7], color);
 
-        drawTriangle(cube[2], cube[3], cube[4], program, color);
-        drawTriangle(cube[2], cube[4], cube[5], program, color);
+        drawTriangle(cube[2], cube[3], cube[4], color);
+        drawTriangle(cube[2], cube[4], cube[5], color);
 
-        drawTriangle(cube[0], cube[1], cube[6], program, color);
-        drawTriangle(cube[0], cube[6], cube[7], program, color);
+        drawTriangle(cube[0], cube[1], cube[6], color);
+        drawTriangle(cube[0], cube[6], cube[7], color);
     }
 
-    void DebugDrawer::drawAxis(const glm::mat4 &trans, ShaderProgram &program, float scale, float lineWidth) {
-        if(!_isInit) init();
-
-        glLineWidth(lineWidth);
+    void DebugDrawer::drawBox(const glm::vec3 &center, const glm::vec3 &dimension, const glm::vec3 &color, float lineWidth) {
+        glm::vec3 offset = dimension / 2.f;
+
+        glm::vec3 points[8] = {
+            glm::vec3(center.x - offset.x, center.y - offset.y, center.z + offset.z),
+            glm::vec3(center.x - offset.x, center.y + offset.y, center.z + offset.z),
+            glm::vec3(center.x + offset.x, center.y + offset.y, center.z + offset.z),
+            glm::vec3(center.x + offset.x, center.y - offset.y, center.z + offset.z),
+            glm::vec3(center.x - offset.x, center.y - offset.y, center.z - offset.z),
+            glm::vec3(center.x - offset.x, center.y + offset.y, center.z - offset.z),
+            glm::vec3(center.x + offset.x, center.y + offset.y, center.z - offset.z),
+            glm::vec3(center.x + offset.x, center.y - offset.y, center.z - offset.z)
+        };
+
+        drawRay(points[0], points[1], color, lineWidth);
+        drawRay(points[1], points[2], color, lineWidth);
+        drawRay(points[2], points[3], color, lineWidth);
+        drawRay(points[3], points[0], color, lineWidth);
+        drawRay(points[4], points[5], color, lineWidth);
+        drawRay(points[5], points[6], color, lineWidth);
+        drawRay(points[6], points[7], color, lineWidth);
+        drawRay(points[7], points[4], color, lineWidth);
+        drawRay(points[0], points[4], color, lineWidth);
+        drawRay(points[1], points[5], color, lineWidth);
+        drawRay(points[3], points[7], color, lineWidth);
+        drawRay(points[2], points[6], color, lineWidth);
+    }
 
+    void DebugDrawer::drawAxis(const glm::mat4 &trans, float scale, float lineWidth) {
         glm::vec3 xAxis = glm::vec3(trans * glm::vec4(1,0,0,0));
         glm::vec3 yAxis = glm::vec3(trans * glm::vec4(0,1,0,0));
         glm::vec3 zAxis = glm::vec3(trans * glm::vec4(0,0,1,0));
 
         glm::vec3 origin = glm::vec3(trans *  glm::vec4(0,0,0,1));
 
-        drawRay(origin, origin + scale * xAxis, program, glm::vec3(1, 0, 0), lineWidth);
-        drawRay(origin, origin + scale * yAxis, program, glm::vec3(0, 1, 0), lineWidth);
-        drawRay(origin, origin + scale * zAxis, program, glm::vec3(0, 0, 1), lineWidth);
+        drawRay(origin, origin + scale * xAxis, glm::vec3(1, 0, 0), lineWidth);
+        drawRay(origin, origin + scale * yAxis, glm::vec3(0, 1, 0), lineWidth);
+        drawRay(origin, origin + scale * zAxis, glm::vec3(0, 0, 1), lineWidth);
     }
 
-    void DebugDrawer::drawTranslateAxis(const glm::mat4 &trans, ShaderProgram &program, float scale, float lineWidth) {
-        if(!_isInit) init();
-
-        drawAxis(trans, program, scale, lineWidth);
+    void DebugDrawer::drawTranslateAxis(const glm::mat4 &trans, float scale, float lineWidth) {
+        drawAxis(trans, scale, lineWidth);
 
-        drawPyramid(trans * glm::rotate(glm::radians(-90.f), glm::vec3(0, 0, 1)), program, scale, glm::vec3(1,0,0));
-        drawPyramid(trans, program, scale, glm::vec3(0,1,0));
-        drawPyramid(trans * glm::rotate(glm::radians(90.f), glm::vec3(1, 0, 0)), program, scale, glm::vec3(0,0,1));
+        drawPyramid(trans * glm::rotate(glm::radians(-90.f), glm::vec3(0, 0, 1)), scale, glm::vec3(1,0,0));
+        drawPyramid(trans, scale, glm::vec3(0,1,0));
+        drawPyramid(trans * glm::rotate(glm::radians(90.f), glm::vec3(1, 0, 0)), scale, glm::vec3(0,0,1));
     }
 
-    void DebugDrawer::drawScaleAxis(const glm::mat4 &trans, ShaderProgram &program, float scale, float lineWidth) {
-        drawAxis(trans, program, scale, lineWidth);
+    void DebugDrawer::drawScaleAxis(const glm::mat4 &trans, float scale, float lineWidth) {
+        drawAxis(trans, scale, lineWidth);
 
-        drawCube(trans * glm::translate(scale*glm::vec3(1,0,0)), program, scale/20.f, glm::vec3(1,0,0));
-        drawCube(trans * glm::translate(scale*glm::vec3(0,1,0)), program, scale/20.f, glm::vec3(0,1,0));
-        drawCube(trans * glm::translate(scale*glm::vec3(0,0,1)), program, scale/20.f, glm::vec3(0,0,1));
+        drawCube(trans * glm::translate(scale*glm::vec3(1,0,0)), scale/20.f, glm::vec3(1,0,0));
+        drawCube(trans * glm::translate(scale*glm::vec3(0,1,0)), scale/20.f, glm::vec3(0,1,0));
+        drawCube(trans * glm::translate(scale*glm::vec3(0,0,1)), scale/20.f, glm::vec3(0,0,1));
     }
 
-    void DebugDrawer::drawRotationAxis(const glm::mat4 &trans, ShaderProgram &program, float scale, float lineWidth) {
+    void DebugDrawer::drawRotationAxis(const glm::mat4 &trans, float scale, float lineWidth) {
+        drawAxis(trans, scale, lineWidth);
+    }
+
+    void DebugDrawer::flush(ShaderProgram &program) {
         if(!_isInit) init();
 
-        drawAxis(trans, program, scale, lineWidth);
+        // All batches are concatenated in a single vertex buffer: triangles, lines then points
+        std::vector<glm::vec3>& vertices = _drawer._vertices;
+        std::vector<glm::vec3>& colors = _drawer._colors;
+        vertices.clear();
+        colors.clear();
+
+        auto append = [&](const Batch& batch) {
+            vertices.insert(vertices.end(), batch.positions.begin(), batch.positions.end());
+            colors.insert(colors.end(), batch.colors.begin(), batch.colors.end());
+        };
+
+        append(_drawer._triangles);
+        for(auto& lines : _drawer._lines)
+            append(lines.second);
+        for(auto& points : _drawer._points)
+            append(points.second);
+
+        if(vertices.empty())
+            return;
+
+        _drawer._verticesVBO.updateData(vertices);
+        _drawer._colorsVBO.updateData(colors);
+
+        program.useProgram();
+        _drawer._VAO.bind();
+
+        GLint first = 0;
+        if(!_drawer._triangles.positions.empty()) {
+            glDrawArrays(GL_TRIANGLES, first, _drawer._triangles.positions.size());
+            first += _drawer._triangles.positions.size();
+        }
+
+        for(auto& lines : _drawer._lines) {
+            if(lines.second.positions.empty()) continue;
+            glLineWidth(lines.first);
+            glDrawArrays(GL_LINES, first, lines.second.positions.size());
+            first += lines.second.positions.size();
+        }
+
+        // Resolved once, then set for each point size without any name lookup
+        UniformHandle<float> pointSize = program.uniform<float>(UBO_keys::DEBUG_POINT_SIZE);
+        glEnable(GL_PROGRAM_POINT_SIZE);
+        for(auto& points : _drawer._points) {
+            if(points.second.positions.empty()) continue;
+            pointSize.set(points.first);
+            glDrawArrays(GL_POINTS, first, points.second.positions.size());
+            first += points.second.positions.size();
+        }
+        glDisable(GL_PROGRAM_POINT_SIZE);
+
+        Graphics::VertexArrayObject::unbindAll();
+        Graphics::VertexBufferObject::unbindAll();
+
+        // Batches keep their capacity for the next frame
+        _drawer._triangles.positions.clear();
+        _drawer._triangles.colors.clear();
+        for(auto& lines : _drawer._lines) {
+            lines.second.positions.clear();
+            lines.second.colors.clear();
+        }
+        for(auto& points : _drawer._points) {
+            points.second.positions.clear();
+            points.second.colors.clear();
+        }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,163 @@
+#include "graphics/ProgramBinaryCache.h"
+#include <glog/logging.h>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iterator>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Graphics
+{
+    namespace
+    {
+        /** $XDG_CACHE_HOME/partykel, or ~/.cache/partykel: the cache never writes in the working directory */
+        std::string defaultDirectory() {
+            const char *cacheHome = std::getenv("XDG_CACHE_HOME");
+            if(cacheHome && cacheHome[0] == '/')
+                return std::string(cacheHome) + "/partykel";
+
+            const char *home = std::getenv("HOME");
+            if(home && home[0] != '\0')
+                return std::string(home) + "/.cache/partykel";
+
+            return std::string();
+        }
+
+        /** Creates the directory and its missing parents */
+        void makeDirectories(const std::string &directory) {
+            for(size_t i = 1; i <= directory.size(); ++i){
+                if(i == directory.size() || directory[i] == '/')
+                    mkdir(directory.substr(0, i).c_str(), 0755);
+            }
+        }
+
+        /** FNV-1a 64 bits */
+        void hash(uint64_t &h, const void *data, size_t size) {
+            const unsigned char *bytes = static_cast<const unsigned char*>(data);
+            for(size_t i = 0; i < size; ++i){
+                h ^= bytes[i];
+                h *= 1099511628211ull;
+            }
+        }
+
+        void hash(uint64_t &h, const std::string &s) {
+            // The length separates the strings: ("ab", "c") and ("a", "bc") give different keys
+            uint64_t length = s.size();
+            hash(h, &length, sizeof(length));
+            hash(h, s.data(), s.size());
+        }
+
+        std::string glString(GLenum name) {
+            const GLubyte *s = glGetString(name);
+            return s ? std::string(reinterpret_cast<const char*>(s)) : std::string();
+        }
+    }
+
+    std::string ProgramBinaryCache::_directory = defaultDirectory();
+
+    bool ProgramBinaryCache::isSupported() {
+        if(_directory.empty() || !(GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary))
+            return false;
+
+        GLint formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        return formatCount > 0;
+    }
+
+    std::string ProgramBinaryCache::path(const std::string &key) {
+        return _directory + "/" + key + ".bin";
+    }
+
+    std::string ProgramBinaryCache::key(const std::vector<std::string> &sources) {
+        uint64_t h = 14695981039346656037ull;
+        hash(h, glString(GL_VENDOR));
+        hash(h, glString(GL_RENDERER));
+        hash(h, glString(GL_VERSION));
+        for(auto &source : sources)
+            hash(h, source);
+
+        std::ostringstream key;
+        key << std::hex << std::setw(16) << std::setfill('0') << h;
+        return key.str();
+    }
+
+    GLuint ProgramBinaryCache::load(const std::string &key) {
+        if(!isSupported())
+            return 0;
+
+        std::ifstream file(path(key), std::ios::binary);
+        if(!file.is_open())
+            return 0;
+
+        // An empty or truncated entry (e.g. disk full while storing) is a miss
+        GLenum format;
+        file.read(reinterpret_cast<char*>(&format), sizeof(format));
+        if(file.gcount() != sizeof(format))
+            return 0;
+
+        std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if((!file.good() && !file.eof()) || binary.empty())
+            return 0;
+
+        GLuint programId = glCreateProgram();
+        glProgramBinary(programId, format, binary.data(), binary.size());
+
+        // The driver may refuse a binary (e.g. after an update keeping the same version string)
+        GLint status;
+        glGetProgramiv(programId, GL_LINK_STATUS, &status);
+        if(status == GL_FALSE){
+            DLOG(INFO) << "ProgramBinaryCache: binary " << key << " rejected by the driver, recompiling";
+            glDeleteProgram(programId);
+            return 0;
+        }
+        return programId;
+    }
+
+    void ProgramBinaryCache::prepare(GLuint programId) {
+        if(isSupported())
+            glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    void ProgramBinaryCache::store(const std::string &key, GLuint programId) {
+        if(!isSupported())
+            return;
+
+        GLint length = 0;
+        glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &length);
+        if(length <= 0)
+            return;
+
+        std::vector<char> binary(length);
+        GLenum format;
+        glGetProgramBinary(programId, length, &length, &format, binary.data());
+
+        makeDirectories(_directory);
+
+        // Written aside then renamed: concurrent runs never read a partial file
+        std::string filePath = path(key);
+        std::string temporaryPath = filePath + "." + std::to_string(getpid());
+        {
+            std::ofstream file(temporaryPath, std::ios::binary);
+            if(!file.is_open()){
+                DLOG(WARNING) << "ProgramBinaryCache: unable to write " << temporaryPath;
+                return;
+            }
+            file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+            file.write(binary.data(), length);
+        }
+        if(std::rename(temporaryPath.c_str(), filePath.c_str()) != 0)
+            std::remove(temporaryPath.c_str());
+    }
+
+    void ProgramBinaryCache::setDirectory(const std::string &directory) {
+        _directory = directory;
+    }
+
+    const std::string& ProgramBinaryCache::directory() {
+        return _directory;
+    }
+}
@@ -9,11 +9,10 @@ using namespace Graphics;
 Shader::Shader(GLenum type, const std::string &path): _idShader(0), _type(type), _path(path) {
     if(_path.empty())
         return;
-    compile();
+    load();
 }
 
-
-void Shader::compile() {
+void Shader::load() {
     std::ifstream shaderFile(_path);
 
     if(!shaderFile.is_open())
@@ -21,8 +20,14 @@ void Shader::compile() {
 
     std::stringstream shaderContent;
     shaderContent << shaderFile.rdbuf();
-    std::string t = shaderContent.str();
-    const char * shaderString = t.c_str();
+    _source = shaderContent.str();
+}
+
+void Shader::compile() {
+    if(_idShader != 0)
+        glDeleteShader(_idShader);
+
+    const char * shaderString = _source.c_str();
 
     _idShader = glCreateShader(_type);
     glShaderSource(_idShader, 1, &shaderString, 0);
@@ -62,9 +67,18 @@ std::string Shader::getPath() const {
 void Shader::changeProperties(GLenum type, const std::string &path) {
     _type = type;
     _path = path;
+    load();
     compile();
 }
 
+const std::string& Shader::source() const {
+    return _source;
+}
+
+bool Shader::isCompiled() const {
+    return _idShader != 0;
+}
+
 GLuint Shader::id() const{
     return _idShader;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "graphics/ShaderProgram.hpp"
+#include "graphics/ProgramBinaryCache.h"
 #include <stdexcept>
 #include <iostream>
 
@@ -14,15 +15,75 @@ ShaderProgram::ShaderProgram(const std::string &vShader, const std::string& gSha
 }
 
 void ShaderProgram::compile() {
-    _programId = glCreateProgram();
-    glAttachShader(_programId, _vertexShader.get()->id());
-    glAttachShader(_programId, _fragShader.get()->id());
+    bool hasGeometryShader = _geometryShader.get() && !_geometryShader.get()->getPath().empty();
+
+    std::string cacheKey = ProgramBinaryCache::key({_vertexShader.get()->source(),
+                                                    hasGeometryShader ? _geometryShader.get()->source() : std::string(),
+                                                    _fragShader.get()->source()});
+    _programId = ProgramBinaryCache::load(cacheKey);
+
+    if(_programId == 0){
+        // Shaders shared with other programs may already be compiled
+        if(!_vertexShader.get()->isCompiled())
+            _vertexShader.get()->compile();
+        if(!_fragShader.get()->isCompiled())
+            _fragShader.get()->compile();
+        if(hasGeometryShader && !_geometryShader.get()->isCompiled())
+            _geometryShader.get()->compile();
+
+        _programId = glCreateProgram();
+        glAttachShader(_programId, _vertexShader.get()->id());
+        glAttachShader(_programId, _fragShader.get()->id());
+
+        if(hasGeometryShader)
+            glAttachShader(_programId, _geometryShader.get()->id());
+
+        ProgramBinaryCache::prepare(_programId);
+        glLinkProgram(_programId);
+        checkLinkErrors();
+        ProgramBinaryCache::store(cacheKey, _programId);
+    }
+
+    cacheUniformLocations();
+}
+
+void ShaderProgram::cacheUniformLocations() {
+    _uniformLocations.clear();
+
+    int uniformCount, maxNameLength;
+    glGetProgramiv(_programId, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(_programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
 
-    if(_geometryShader.get() && _geometryShader.get()->id() != 0)
-        glAttachShader(_programId, _geometryShader.get()->id());
+    std::vector<GLchar> name(maxNameLength);
+    for(int i = 0; i < uniformCount; ++i){
+        GLsizei length;
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(_programId, i, maxNameLength, &length, &size, &type, name.data());
+
+        // Uniforms of blocks have no location
+        GLint location = glGetUniformLocation(_programId, name.data());
+        if(location == -1)
+            continue;
+
+        std::string uniformName(name.data(), length);
+        _uniformLocations[uniformName] = location;
+
+        // Arrays are reported as "name[0]": also register "name" and every "name[k]"
+        if(length > 3 && uniformName.compare(length - 3, 3, "[0]") == 0){
+            std::string baseName = uniformName.substr(0, length - 3);
+            _uniformLocations[baseName] = location;
+            for(int k = 1; k < size; ++k){
+                std::string elementName = baseName + "[" + std::to_string(k) + "]";
+                _uniformLocations[elementName] = glGetUniformLocation(_programId, elementName.c_str());
+            }
+        }
+    }
+}
 
-    glLinkProgram(_programId);
-    checkLinkErrors();
+GLint ShaderProgram::uniformLocation(const std::string& uniformName) const {
+    auto it = _uniformLocations.find(uniformName);
+    return it == _uniformLocations.end() ? -1 : it->second;
 }
 
 ShaderProgram::ShaderProgram(const std::shared_ptr<Shader>& vShader, const std::shared_ptr<Shader>& fShader):
@@ -68,31 +129,31 @@ GLuint ShaderProgram::id() const {
 }
 
 void ShaderProgram::updateUniform(const std::string& uniformName, float v){
-    glProgramUniform1f(_programId, glGetUniformLocation(_programId, uniformName.c_str()), v);
+    programUniform(_programId, uniformLocation(uniformName), v);
 }
 
 void ShaderProgram::updateUniform(const std::string& uniformName, int v){
-    glProgramUniform1i(_programId, glGetUniformLocation(_programId, uniformName.c_str()), v);
+    programUniform(_programId, uniformLocation(uniformName), v);
 }
 
 void ShaderProgram::updateUniform(const std::string& uniformName, const glm::vec2 & v){
-    glProgramUniform2fv(_programId, glGetUniformLocation(_programId, uniformName.c_str()), 1, glm::value_ptr(v));
+    programUniform(_programId, uniformLocation(uniformName), v);
 }
 
 void ShaderProgram::updateUniform(const std::string& uniformName, const glm::ivec2 & v){
-    glProgramUniform2iv(_programId, glGetUniformLocation(_programId, uniformName.c_str()), 1, glm::value_ptr(v));
+    programUniform(_programId, uniformLocation(uniformName), v);
 }
 
 void ShaderProgram::updateUniform(const std::string& uniformName, const glm::vec3 & v){
-    glProgramUniform3fv(_programId, glGetUniformLocation(_programId, uniformName.c_str()), 1, glm::value_ptr(v));
+    programUniform(_programId, uniformLocation(uniformName), v);
 }
 
 void ShaderProgram::updateUniform(const std::string &uniformName, const glm::mat3 &v) {
-    glProgramUniformMatrix3fv(_programId, glGetUniformLocation(_programId, uniformName.c_str()), 1, 0, glm::value_ptr(v));
+    programUniform(_programId, uniformLocation(uniformName), v);
 }
 
 void ShaderProgram::updateUniform(const std::string& uniformName, const glm::mat4 & v){
-    glProgramUniformMatrix4fv(_programId, glGetUniformLocation(_programId, uniformName.c_str()), 1, 0, glm::value_ptr(v));
+    programUniform(_programId, uniformLocation(uniformName), v);
 }
 
 void ShaderProgram::updateBindingPointUBO(const std::string &uniformName, GLuint uboBindingPoint){
@@ -100,7 +161,7 @@ void ShaderProgram::updateBindingPointUBO(const std::string &uniformName, GLuint
 }
 
 void ShaderProgram::updateUniform(const std::string& uniformName, const std::vector<glm::vec3> & v){
-    glProgramUniform3fv(_programId, glGetUniformLocation(_programId, uniformName.c_str()), v.size(), (float*)v.data());
+    programUniform(_programId, uniformLocation(uniformName), v);
 }
 
 ShaderProgram::~ShaderProgram() {
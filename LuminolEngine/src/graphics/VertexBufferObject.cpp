@@ -4,12 +4,15 @@
 
 #include "graphics/VertexBufferObject.h"
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 #include <glog/logging.h>
 
 namespace Graphics
 {
 
-    VertexBufferObject::VertexBufferObject(DataType dataType, GLuint attribArray, bool initGL) : _dataType(dataType), _attribArray(attribArray), _isInGPU(initGL) {
+    VertexBufferObject::VertexBufferObject(DataType dataType, GLuint attribArray, bool initGL, BufferUsage usage) :
+            _dataType(dataType), _attribArray(attribArray), _isInGPU(initGL), _usage(usage), _capacity(0), _size(0) {
         if(initGL)
             glGenBuffers(1, &_glId);
         _target = _dataType == ELEMENT_ARRAY_BUFFER ? GL_ELEMENT_ARRAY_BUFFER : GL_ARRAY_BUFFER;
@@ -21,10 +24,15 @@ namespace Graphics
         std::swap(_target, other._target);
         std::swap(_attribArray, other._attribArray);
         std::swap(_isInGPU, other._isInGPU);
+        _usage = other._usage;
+        _capacity = other._capacity;
+        _size = other._size;
         other._glId = 0;
+        other._capacity = 0;
+        other._size = 0;
     }
 
-    VertexBufferObject::VertexBufferObject(const VertexBufferObject &other): VertexBufferObject(other._dataType, other._attribArray, other._isInGPU) {}
+    VertexBufferObject::VertexBufferObject(const VertexBufferObject &other): VertexBufferObject(other._dataType, other._attribArray, other._isInGPU, other._usage) {}
 
     void VertexBufferObject::initGL() {
         if(_isInGPU){
@@ -69,6 +77,10 @@ namespace Graphics
                 initVboInstanceVec3();
                 break;
 
+            case INSTANCE_FLOAT_BUFFER:
+                initVboInstanceFloat();
+                break;
+
             case INSTANCE_TRANSFORMATION_BUFFER:
                 initVboInstanceMat4();
                 break;
@@ -125,6 +137,13 @@ namespace Graphics
         glVertexAttribDivisor( _attribArray, 1 );
     }
 
+    void VertexBufferObject::initVboInstanceFloat() {
+        bind();
+        glEnableVertexAttribArray( _attribArray );
+        glVertexAttribPointer( _attribArray, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0 );
+        glVertexAttribDivisor( _attribArray, 1 );
+    }
+
     void VertexBufferObject::initVboInstanceMat4() {
         bind();
 
@@ -145,40 +164,95 @@ namespace Graphics
     }
 
     void VertexBufferObject::updateData(const std::vector<VertexDescriptor>& data){
-        bind();
-        glBufferData(_target, data.size() * sizeof(Graphics::VertexDescriptor), data.data(), GL_STATIC_DRAW);
+        upload(data.data(), data.size() * sizeof(Graphics::VertexDescriptor));
     }
 
     void VertexBufferObject::updateData(const std::vector<glm::vec3>& data){
-        bind();
-        glBufferData(_target, data.size() * 3 * sizeof(GL_FLOAT), data.data(), GL_STATIC_DRAW);
+        upload(data.data(), data.size() * sizeof(glm::vec3));
     }
 
     void VertexBufferObject::updateData(const std::vector<glm::vec2>& data){
-        bind();
-        glBufferData(_target, data.size() * 2 * sizeof(GL_FLOAT), data.data(), GL_STATIC_DRAW);
+        upload(data.data(), data.size() * sizeof(glm::vec2));
     }
 
     void VertexBufferObject::updateData(const std::vector<float>& data){
-        bind();
-        glBufferData(_target, data.size() * sizeof(GL_FLOAT), data.data(), GL_STATIC_DRAW);
+        upload(data.data(), data.size() * sizeof(float));
     }
 
     void VertexBufferObject::updateData(const std::vector<int>& data){
-        bind();
-        glBufferData(_target, data.size() * sizeof(GL_INT), data.data(), GL_STATIC_DRAW);
+        upload(data.data(), data.size() * sizeof(int));
     }
 
 
     void VertexBufferObject::updateData(const std::vector<glm::mat4> &data) {
+        upload(data.data(), data.size() * sizeof(glm::mat4));
+    }
+
+    void VertexBufferObject::upload(const void* data, GLsizeiptr size){
         bind();
-        glBufferData(_target, data.size() * sizeof(glm::mat4), data.data(), GL_STATIC_DRAW);
+        _size = size;
+
+        static const GLenum glUsages[] = {GL_STATIC_DRAW, GL_DYNAMIC_DRAW, GL_STREAM_DRAW};
+
+        if(_usage == STATIC){
+            glBufferData(_target, size, data, GL_STATIC_DRAW);
+            _capacity = size;
+            return;
+        }
+
+        if(size > _capacity){
+            _capacity = std::max(size, 2 * _capacity);
+            glBufferData(_target, _capacity, nullptr, glUsages[_usage]);
+        }
+
+        if(size == 0)
+            return;
+
+        if(_usage == STREAM){
+            // The previous content is invalidated: the driver gives fresh memory instead of waiting for the GPU
+            void* dst = glMapBufferRange(_target, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+            if(dst){
+                std::memcpy(dst, data, size);
+                glUnmapBuffer(_target);
+                return;
+            }
+        }
+        glBufferSubData(_target, 0, size, data);
+    }
+
+    void VertexBufferObject::uploadRange(const void* data, GLintptr offset, GLsizeiptr size){
+        // Only bytes defined by the last updateData can be replaced (the rest of the capacity is undefined)
+        if(offset < 0 || offset + size > _size){
+            DLOG(ERROR) << "VertexBufferObject::updateSubData range [" << offset << ", " << offset + size << "[ out of the data (" << _size << " bytes)";
+            return;
+        }
+        if(size == 0)
+            return;
+
+        bind();
+        glBufferSubData(_target, offset, size, data);
     }
 
     void VertexBufferObject::setAttribArray(GLuint value){
         _attribArray = value;
     }
 
+    void VertexBufferObject::setUsage(BufferUsage usage){
+        _usage = usage;
+    }
+
+    BufferUsage VertexBufferObject::usage() const{
+        return _usage;
+    }
+
+    GLsizeiptr VertexBufferObject::capacity() const{
+        return _capacity;
+    }
+
+    GLsizeiptr VertexBufferObject::size() const{
+        return _size;
+    }
+
     void VertexBufferObject::unbindAll(){
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
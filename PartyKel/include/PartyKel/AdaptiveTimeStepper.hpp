@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include "PartyKel/Flag.hpp"
+#include "PartyKel/Integrator.hpp"
+
+namespace PartyKel{
+    // Découpe le pas d'une frame en sous-pas lorsque le drapeau l'exige.
+    // Le sous-pas suit l'estimation de Flag::estimateStableTimeStep, mais ne regrandit que
+    // progressivement (growthFactor par sous-pas) afin d'éviter d'osciller entre 1 et n sous-pas.
+    // Une frame calme ne coûte donc qu'un seul pas.
+    class AdaptiveTimeStepper{
+        float m_fSafetyFactor;
+        float m_fMaxDisplacement;
+        float m_fGrowthFactor;
+        float m_fMinTimeStep;
+
+        float m_fTimeStep;
+        uint32_t m_nLastSubStepCount;
+    public:
+        AdaptiveTimeStepper(float safetyFactor = 0.9f, float maxDisplacement = 0.5f, float growthFactor = 1.25f, float minTimeStep = 0.001f);
+
+        // Fait avancer le drapeau de frameDt. brakeDt est le pas utilisé par computeForces pour les freins
+        // (conservé à la durée de la frame pour que l'amortissement ne dépende pas du nombre de sous-pas).
+        // Renvoit le nombre de sous-pas effectués.
+        uint32_t advance(Flag& flag, AbstractIntegrator<glm::vec3>& integrator, float frameDt, float brakeDt, const ForceEvaluator& computeForces);
+
+        void reset();
+
+        float getTimeStep() const;
+        uint32_t getLastSubStepCount() const;
+
+        float& safetyFactor();
+        float& maxDisplacement();
+        float& growthFactor();
+    };
+}
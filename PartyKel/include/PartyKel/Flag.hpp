@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+#include "PartyKel/glm.hpp"
+#include "PartyKel/GridPatch.hpp"
+#include "PartyKel/Integrator.hpp"
+#include "PartyKel/Octree.h"
+#include "PartyKel/WindField.hpp"
+#include "PartyKel/renderer/Sphere.hpp"
+#include "geometry/Frustum.h"
+
+namespace PartyKel{
+
+    // Structure permettant de simuler un drapeau à l'aide un système masse-ressort
+    struct Flag {
+        int gridWidth, gridHeight; // Dimensions de la grille de points
+
+        // Propriétés physique des points:
+        std::vector<glm::vec3> positionArray;
+        std::vector<glm::vec3> velocityArray;
+        std::vector<float> massArray;
+        std::vector<glm::vec3> forceArray;
+        std::vector<uint8_t> awakeArray; // 0 pour un point endormi: ni forces ni intégration (voir TileSleepController)
+        int nbParticles;
+
+        // Produit vectoriel (b - a) x (c - a) de chaque triangle, de norme 2 * aire. Deux triangles par case
+        // de la grille (A B C puis A C D, voir GridIndexBuffer), cases ligne par ligne. Mis à jour par applyAerodynamicForces
+        std::vector<glm::vec3> triangleNormalArray;
+
+        // Découpage de la grille en carrés de cases (voir GridPatch) et boîte englobante de chaque carré (en SoA),
+        // mise à jour à chaque pas (update) pour le frustum culling du rendu
+        std::vector<GridPatch> patchArray;
+        Geometry::AABBArray patchBounds;
+
+        // Paramètres des forces interne de simulation
+        // Longueurs à vide
+        glm::vec2 L0;
+        float L1;
+        glm::vec2 L2;
+
+        float K0, K1, K2; // Paramètres de résistance
+        float V0, V1, V2; // Paramètres de frein
+
+        // Coefficients aérodynamiques de traînée et de portance (densité de l'air incluse)
+        float Cd, Cl;
+
+        // Créé un drapeau discretisé sous la forme d'une grille contenant gridWidth * gridHeight
+        // points. Chaque point a pour masse mass / (gridWidth * gridHeight).
+        // La taille du drapeau en 3D est spécifié par les paramètres width et height
+        Flag(float mass, float width, float height, int gridWidth, int gridHeight);
+
+        // Applique les forces internes sur chaque point du drapeau SAUF les points fixes
+        void applyInternalForces(float dt);
+
+        void applyRepulseForces(Octree<glm::vec3>& octree, float maxDst, float multRepulse);
+
+        // Applique une force externe sur chaque point du drapeau SAUF les points fixes
+        void applyExternalForce(const glm::vec3& F);
+
+        // Applique le vent échantillonné à la position de chaque point SAUF les points fixes,
+        // multiplié par scale (voir FlagLOD::getPointScale)
+        void applyWindField(const WindField& windField, float time, float scale = 1.f);
+
+        // Applique les forces de pression de l'air sur chaque triangle, selon la vitesse relative entre le vent
+        // (windField multiplié par windSpeed, échantillonné au centre du triangle) et le triangle:
+        // - traînée Cd * A * |v|^2 * cos(theta), dans la direction du vent relatif
+        // - portance Cl * A * |v|^2 * cos(theta) * sin(theta), perpendiculaire au vent relatif
+        // Un tiers de la force de chaque triangle est réparti sur ses sommets SAUF les points fixes.
+        // Les normales des triangles sont calculées dans la même passe (triangleNormalArray)
+        void applyAerodynamicForces(const WindField& windField, float time, float windSpeed);
+
+        void applySphereCollision(const SphereHandler& sphereHandler, float multiplier, float radiusDelta);
+
+        // Met à jour la vitesse et la position de chaque point du drapeau avec le schéma d'intégration donné.
+        // computeForces doit appliquer toutes les forces voulues (il peut être appelé plusieurs fois par pas)
+        void update(AbstractIntegrator<glm::vec3>& integrator, float dt, const ForceEvaluator& computeForces);
+
+        // Estime le plus grand pas de temps stable pour le schéma explicite:
+        // - ressorts et freins: borne de Gershgorin sur la raideur / l'amortissement d'un point, rapportée à la plus petite masse
+        // - déformation: aucun ressort ne doit varier de plus de maxDisplacement fois la plus petite longueur à vide
+        //   en un pas, d'après les vitesses relatives et les dernières forces calculées entre voisins directs
+        // stabilityLimit est la limite omega * dt du schéma, brakeDt le pas passé à applyInternalForces
+        float estimateStableTimeStep(float stabilityLimit, float brakeDt, float maxDisplacement) const;
+
+        // Recalcule les boîtes englobantes des carrés (à appeler si les positions sont modifiées hors de update)
+        void updatePatchBounds();
+
+        // visiblePatches[k] vaut 1 si le carré k est visible par la matrice MVP, 0 sinon (test des boîtes par paquets de 4,
+        // voir Geometry::Frustum::cull). Renvoie le nombre de carrés visibles
+        uint32_t computeVisiblePatches(const glm::mat4& MVP, std::vector<uint8_t>& visiblePatches) const;
+
+        // Boîte englobante du drapeau entier, union de celles des carrés
+        void getAABB(glm::vec3& AABBmin, glm::vec3& AABBmax) const;
+
+        ParticleArrays<glm::vec3> getParticleArrays();
+    };
+}
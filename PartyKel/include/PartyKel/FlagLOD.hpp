@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include "PartyKel/glm.hpp"
+#include "PartyKel/Flag.hpp"
+#include "PartyKel/renderer/GridSubdivider.hpp"
+
+namespace PartyKel{
+    // Niveaux de détail de la simulation d'un drapeau selon sa distance à la caméra.
+    // Le niveau 0 est la grille complète, chaque niveau suivant a 2 fois moins de cases dans chaque direction
+    // (4 fois moins de points) et sert à partir d'une distance 2 fois plus grande: le nombre de points simulés
+    // suit la surface du drapeau à l'écran, pas le nombre de drapeaux.
+    //
+    // Au changement de niveau, positions et vitesses sont rééchantillonnées sur la grille du nouveau niveau
+    // (surface de Catmull-Rom, voir GridSubdivider, qui conserve la ligne fixe). Le niveau ne change qu'une fois
+    // le seuil dépassé de hysteresis fois sa distance, pour ne pas alterner entre 2 niveaux autour d'un seuil.
+    //
+    // La masse d'un point est proportionnelle à la surface qu'il représente (getPointScale): les forces appliquées
+    // par point (applyExternalForce, applyWindField) doivent être multipliées par getPointScale pour que
+    // le drapeau garde le même mouvement à tous les niveaux.
+    class FlagLOD{
+        std::vector<Flag> m_levels;
+        std::vector<float> m_pointScales;
+        std::vector<GridSubdivider> m_upSamplers; // Niveau l + 1 vers le niveau 0, pour le rendu
+
+        int m_nLevel;
+        float m_fBaseDistance;
+        float m_fHysteresis;
+
+        // Copie l'état du niveau courant dans le niveau level, qui devient le niveau courant
+        void transfer(int level);
+    public:
+        // Mêmes paramètres que le constructeur de Flag pour le niveau 0. Le niveau 1 sert au-delà de baseDistance,
+        // le niveau l au-delà de baseDistance * 2^(l - 1). Les grilles ont au moins 2 x 2 points
+        FlagLOD(float mass, float width, float height, int gridWidth, int gridHeight,
+                int levelCount = 3, float baseDistance = 20.f, float hysteresis = 0.1f);
+
+        // Choisit le niveau selon la distance entre cameraPosition et le centre du drapeau.
+        // Renvoie true si le niveau a changé: l'état d'un intégrateur à mémoire (PositionVerlet)
+        // ou d'un TileSleepController associé au drapeau doit alors être réinitialisé
+        bool update(const glm::vec3& cameraPosition);
+
+        // Force le niveau (l'état est transféré comme par update)
+        void setLevel(int level);
+
+        // Drapeau simulé au niveau courant. Les paramètres (raideurs, freins, coefficients aérodynamiques)
+        // sont recopiés d'un niveau à l'autre
+        Flag& getFlag();
+        const Flag& getFlag() const;
+
+        // Positions du niveau courant évaluées sur la grille du niveau 0 (gridWidth * gridHeight points),
+        // valides jusqu'à l'appel suivant: le rendu garde la même résolution à tous les niveaux
+        const glm::vec3* getFullResolutionPositions();
+
+        // Surface représentée par un point du niveau courant, rapportée à celle d'un point du niveau 0
+        float getPointScale() const;
+
+        int getLevel() const;
+        int getLevelCount() const;
+
+        float& baseDistance();
+        float& hysteresis();
+    };
+}
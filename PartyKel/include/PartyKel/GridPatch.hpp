@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+namespace PartyKel{
+
+    // Carré de cases d'une grille de points: cases [quadBeginI, quadEndI[ x [quadBeginJ, quadEndJ[,
+    // soit les points [quadBeginI, quadEndI] x [quadBeginJ, quadEndJ]
+    struct GridPatch{
+        int quadBeginI, quadBeginJ;
+        int quadEndI, quadEndJ;
+    };
+
+    // Côté des carrés en cases: la largeur des bandes de GridIndexBuffer, dont les indices d'un carré sont alors contigus
+    static const int GRID_PATCH_QUADS = 15;
+
+    // Découpe une grille de gridWidth * gridHeight points en carrés de patchQuads x patchQuads cases
+    // (plus petits sur les bords), colonne de carrés par colonne de carrés, de bas en haut
+    std::vector<GridPatch> buildGridPatches(int gridWidth, int gridHeight, int patchQuads = GRID_PATCH_QUADS);
+
+    // Nombre de colonnes et de lignes de carrés: le carré (x, y) est le carré x * patchRowCount + y
+    inline int gridPatchColumnCount(int gridWidth, int patchQuads = GRID_PATCH_QUADS){
+        return (gridWidth - 2) / patchQuads + 1;
+    }
+
+    inline int gridPatchRowCount(int gridHeight, int patchQuads = GRID_PATCH_QUADS){
+        return (gridHeight - 2) / patchQuads + 1;
+    }
+}
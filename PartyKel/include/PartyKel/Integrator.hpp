@@ -0,0 +1,231 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace PartyKel{
+
+    // Fonction chargée d'accumuler toutes les forces dans le tableau de forces, à partir des
+    // positions et vitesses courantes. L'intégrateur remet les forces à zéro avant chaque appel.
+    typedef std::function<void()> ForceEvaluator;
+
+    // Vue sur les tableaux d'un système de particules (2D avec glm::vec2, 3D avec glm::vec3)
+    template<typename Vec>
+    struct ParticleArrays{
+        uint32_t count;
+        Vec* positions;
+        Vec* velocities;
+        Vec* forces;
+        const float* masses;
+        const uint8_t* awake; // nullptr si toutes les particules sont simulées, sinon 0 pour une particule endormie
+
+        bool isAwake(uint32_t i) const{
+            return !awake || awake[i];
+        }
+    };
+
+    // Schéma d'intégration partagé par le ParticleManager2D et le drapeau 3D.
+    // Les états intermédiaires (RK4, Verlet) sont écrits directement dans positions/velocities
+    // avant chaque évaluation des forces, de sorte que le ForceEvaluator lit toujours les
+    // tableaux habituels. A la fin d'un pas, forces contient la dernière évaluation.
+    // Les particules endormies (voir ParticleArrays::awake) ne sont pas intégrées.
+    template<typename Vec>
+    class AbstractIntegrator{
+        const ForceEvaluator* m_pComputeForces;
+        uint32_t m_nLastStepForceEvaluations;
+        uint64_t m_nTotalForceEvaluations;
+
+    protected:
+        ParticleArrays<Vec> m_particles;
+
+        // Remet les forces à zéro puis appelle le ForceEvaluator
+        void evaluateForces(){
+            for(uint32_t i = 0; i < m_particles.count; ++i)
+                m_particles.forces[i] = Vec(0);
+            (*m_pComputeForces)();
+            ++m_nLastStepForceEvaluations;
+            ++m_nTotalForceEvaluations;
+        }
+
+        virtual void integrate(float dt) = 0;
+
+    public:
+        AbstractIntegrator(): m_pComputeForces(nullptr), m_nLastStepForceEvaluations(0), m_nTotalForceEvaluations(0), m_particles() {}
+        virtual ~AbstractIntegrator(){}
+
+        void step(const ParticleArrays<Vec>& particles, float dt, const ForceEvaluator& computeForces){
+            m_particles = particles;
+            m_pComputeForces = &computeForces;
+            m_nLastStepForceEvaluations = 0;
+            integrate(dt);
+            m_pComputeForces = nullptr;
+        }
+
+        // Invalide les données conservées d'un pas à l'autre (à appeler si l'état est modifié hors de step)
+        virtual void reset(){}
+
+        virtual const char* getName() const = 0;
+
+        // Nombre d'évaluations des forces par pas en régime établi
+        virtual uint32_t getForceEvaluationsPerStep() const = 0;
+
+        // Plus grand produit omega * dt stable pour un oscillateur harmonique non amorti
+        virtual float getStabilityLimit() const{ return 2.f; }
+
+        uint32_t getLastStepForceEvaluations() const{
+            return m_nLastStepForceEvaluations;
+        }
+
+        uint64_t getTotalForceEvaluations() const{
+            return m_nTotalForceEvaluations;
+        }
+    };
+
+    // Euler symplectique (le schéma historiquement appelé "Leapfrog" dans PartyKel):
+    // v(t+dt) = v(t) + dt * a(t), x(t+dt) = x(t) + dt * v(t+dt). Ordre 1, 1 évaluation par pas.
+    template<typename Vec>
+    class SymplecticEulerIntegrator: public AbstractIntegrator<Vec>{
+    protected:
+        void integrate(float dt) override{
+            auto& p = this->m_particles;
+            this->evaluateForces();
+            for(uint32_t i = 0; i < p.count; ++i){
+                if(!p.isAwake(i))
+                    continue;
+                p.velocities[i] += dt * (p.forces[i] / p.masses[i]);
+                p.positions[i] += dt * p.velocities[i];
+            }
+        }
+
+    public:
+        const char* getName() const override{ return "SymplecticEuler"; }
+        uint32_t getForceEvaluationsPerStep() const override{ return 1; }
+    };
+
+    // Verlet vitesse (kick - drift - kick). Ordre 2 pour des forces ne dépendant que des positions,
+    // les freins (forces dépendant de la vitesse) sont évalués à la demi-vitesse et restent d'ordre 1.
+    // Les forces évaluées en fin de pas sont réutilisées au début du pas suivant,
+    // seul le premier pas (ou celui suivant un reset) coûte 2 évaluations.
+    template<typename Vec>
+    class VelocityVerletIntegrator: public AbstractIntegrator<Vec>{
+        std::vector<Vec> m_cachedForces;
+        bool m_bCacheValid = false;
+
+    protected:
+        void integrate(float dt) override{
+            auto& p = this->m_particles;
+            float halfDt = 0.5f * dt;
+
+            if(m_bCacheValid && m_cachedForces.size() == p.count){
+                for(uint32_t i = 0; i < p.count; ++i)
+                    p.forces[i] = m_cachedForces[i];
+            } else {
+                this->evaluateForces();
+            }
+
+            for(uint32_t i = 0; i < p.count; ++i){
+                if(!p.isAwake(i))
+                    continue;
+                p.velocities[i] += halfDt * (p.forces[i] / p.masses[i]);
+                p.positions[i] += dt * p.velocities[i];
+            }
+
+            this->evaluateForces();
+
+            m_cachedForces.resize(p.count);
+            for(uint32_t i = 0; i < p.count; ++i){
+                m_cachedForces[i] = p.forces[i];
+                if(p.isAwake(i))
+                    p.velocities[i] += halfDt * (p.forces[i] / p.masses[i]);
+            }
+            m_bCacheValid = true;
+        }
+
+    public:
+        void reset() override{ m_bCacheValid = false; }
+        const char* getName() const override{ return "VelocityVerlet"; }
+        uint32_t getForceEvaluationsPerStep() const override{ return 1; }
+    };
+
+    // Verlet position (drift - kick - drift). Ordre 2 (1 pour les freins, comme Verlet vitesse),
+    // 1 évaluation par pas, sans état conservé.
+    template<typename Vec>
+    class PositionVerletIntegrator: public AbstractIntegrator<Vec>{
+    protected:
+        void integrate(float dt) override{
+            auto& p = this->m_particles;
+            float halfDt = 0.5f * dt;
+
+            for(uint32_t i = 0; i < p.count; ++i){
+                if(p.isAwake(i))
+                    p.positions[i] += halfDt * p.velocities[i];
+            }
+
+            this->evaluateForces();
+
+            for(uint32_t i = 0; i < p.count; ++i){
+                if(!p.isAwake(i))
+                    continue;
+                p.velocities[i] += dt * (p.forces[i] / p.masses[i]);
+                p.positions[i] += halfDt * p.velocities[i];
+            }
+        }
+
+    public:
+        const char* getName() const override{ return "PositionVerlet"; }
+        uint32_t getForceEvaluationsPerStep() const override{ return 1; }
+    };
+
+    // Runge-Kutta classique d'ordre 4, 4 évaluations par pas.
+    template<typename Vec>
+    class RK4Integrator: public AbstractIntegrator<Vec>{
+        std::vector<Vec> m_initialPositions, m_initialVelocities;
+        std::vector<Vec> m_sumPositions, m_sumVelocities;
+
+    protected:
+        void integrate(float dt) override{
+            auto& p = this->m_particles;
+
+            m_initialPositions.assign(p.positions, p.positions + p.count);
+            m_initialVelocities.assign(p.velocities, p.velocities + p.count);
+            m_sumPositions.assign(p.count, Vec(0));
+            m_sumVelocities.assign(p.count, Vec(0));
+
+            // Poids de chaque étage dans la somme finale et position (en fraction de dt) de l'étage suivant
+            static const float weights[3] = {1.f, 2.f, 2.f};
+            static const float nextStage[3] = {0.5f, 0.5f, 1.f};
+
+            for(int s = 0; s < 3; ++s){
+                this->evaluateForces();
+                float c = nextStage[s] * dt;
+                for(uint32_t i = 0; i < p.count; ++i){
+                    if(!p.isAwake(i))
+                        continue;
+                    Vec kx = p.velocities[i];
+                    Vec kv = p.forces[i] / p.masses[i];
+                    m_sumPositions[i] += weights[s] * kx;
+                    m_sumVelocities[i] += weights[s] * kv;
+                    p.positions[i] = m_initialPositions[i] + c * kx;
+                    p.velocities[i] = m_initialVelocities[i] + c * kv;
+                }
+            }
+
+            this->evaluateForces();
+            float sixthDt = dt / 6.f;
+            for(uint32_t i = 0; i < p.count; ++i){
+                if(!p.isAwake(i))
+                    continue;
+                Vec kx = p.velocities[i];
+                Vec kv = p.forces[i] / p.masses[i];
+                p.positions[i] = m_initialPositions[i] + sixthDt * (m_sumPositions[i] + kx);
+                p.velocities[i] = m_initialVelocities[i] + sixthDt * (m_sumVelocities[i] + kv);
+            }
+        }
+
+    public:
+        const char* getName() const override{ return "RK4"; }
+        uint32_t getForceEvaluationsPerStep() const override{ return 4; }
+        float getStabilityLimit() const override{ return 2.8f; }
+    };
+}
@@ -108,16 +108,16 @@ namespace PartyKel
         bool contains(const glm::vec3& position);
 
         /**
-         * Debug draw using LuminolEngine DebugDrawer.
+         * Debug draw using LuminolEngine DebugDrawer (recorded, drawn by DebugDrawer::flush).
          * Draw the Boundaries of the octree
          */
-        void draw(Graphics::ShaderProgram& program);
+        void draw(const glm::vec3& color = glm::vec3(1, 1, 1));
 
         /**
-         * Debug draw using LuminolEngine DebugDrawer.
+         * Debug draw using LuminolEngine DebugDrawer (recorded, drawn by DebugDrawer::flush).
          * Draw the Boundaries of leafs that contain at least 1 value
          */
-        void drawRecursive(Graphics::ShaderProgram& program);
+        void drawRecursive(const glm::vec3& color = glm::vec3(1, 1, 1));
 
         void printRecursive();
 
@@ -282,69 +282,22 @@ namespace PartyKel
     }
 
     template <typename T>
-    void Octree<T>::drawRecursive(Graphics::ShaderProgram& program){
+    void Octree<T>::drawRecursive(const glm::vec3& color){
         if(_depth != 0 ){
             for(auto& child : _children){
-                child.drawRecursive(program);
+                child.drawRecursive(color);
             }
             return;
         }
 
         if(_depth == 0 && _values.empty()) return;
 
-        glm::vec3 offset = _dimension / 2.f;
-
-        std::vector<glm::vec3> points;
-        points.push_back(glm::vec3(_position.x - offset.x, _position.y - offset.y, _position.z + offset.z));
-        points.push_back(glm::vec3(_position.x - offset.x, _position.y + offset.y, _position.z + offset.z));
-        points.push_back(glm::vec3(_position.x + offset.x, _position.y + offset.y, _position.z + offset.z));
-        points.push_back(glm::vec3(_position.x + offset.x, _position.y - offset.y, _position.z + offset.z));
-        points.push_back(glm::vec3(_position.x - offset.x, _position.y - offset.y, _position.z - offset.z));
-        points.push_back(glm::vec3(_position.x - offset.x, _position.y + offset.y, _position.z - offset.z));
-        points.push_back(glm::vec3(_position.x + offset.x, _position.y + offset.y, _position.z - offset.z));
-        points.push_back(glm::vec3(_position.x + offset.x, _position.y - offset.y, _position.z - offset.z));
-
-        Graphics::DebugDrawer::drawRay(points[0], points[1], program);
-        Graphics::DebugDrawer::drawRay(points[1], points[2], program);
-        Graphics::DebugDrawer::drawRay(points[2], points[3], program);
-        Graphics::DebugDrawer::drawRay(points[3], points[0], program);
-        Graphics::DebugDrawer::drawRay(points[4], points[5], program);
-        Graphics::DebugDrawer::drawRay(points[5], points[6], program);
-        Graphics::DebugDrawer::drawRay(points[6], points[7], program);
-        Graphics::DebugDrawer::drawRay(points[7], points[4], program);
-        Graphics::DebugDrawer::drawRay(points[0], points[4], program);
-        Graphics::DebugDrawer::drawRay(points[1], points[5], program);
-        Graphics::DebugDrawer::drawRay(points[3], points[7], program);
-        Graphics::DebugDrawer::drawRay(points[2], points[6], program);
+        Graphics::DebugDrawer::drawBox(_position, _dimension, color);
     }
 
     template <typename T>
-    void Octree<T>::draw(Graphics::ShaderProgram& program){
-
-        glm::vec3 offset = _dimension / 2.f;
-
-        std::vector<glm::vec3> points;
-        points.push_back(glm::vec3(_position.x - offset.x, _position.y - offset.y, _position.z + offset.z));
-        points.push_back(glm::vec3(_position.x - offset.x, _position.y + offset.y, _position.z + offset.z));
-        points.push_back(glm::vec3(_position.x + offset.x, _position.y + offset.y, _position.z + offset.z));
-        points.push_back(glm::vec3(_position.x + offset.x, _position.y - offset.y, _position.z + offset.z));
-        points.push_back(glm::vec3(_position.x - offset.x, _position.y - offset.y, _position.z - offset.z));
-        points.push_back(glm::vec3(_position.x - offset.x, _position.y + offset.y, _position.z - offset.z));
-        points.push_back(glm::vec3(_position.x + offset.x, _position.y + offset.y, _position.z - offset.z));
-        points.push_back(glm::vec3(_position.x + offset.x, _position.y - offset.y, _position.z - offset.z));
-
-        Graphics::DebugDrawer::drawRay(points[0], points[1], program);
-        Graphics::DebugDrawer::drawRay(points[1], points[2], program);
-        Graphics::DebugDrawer::drawRay(points[2], points[3], program);
-        Graphics::DebugDrawer::drawRay(points[3], points[0], program);
-        Graphics::DebugDrawer::drawRay(points[4], points[5], program);
-        Graphics::DebugDrawer::drawRay(points[5], points[6], program);
-        Graphics::DebugDrawer::drawRay(points[6], points[7], program);
-        Graphics::DebugDrawer::drawRay(points[7], points[4], program);
-        Graphics::DebugDrawer::drawRay(points[0], points[4], program);
-        Graphics::DebugDrawer::drawRay(points[1], points[5], program);
-        Graphics::DebugDrawer::drawRay(points[3], points[7], program);
-        Graphics::DebugDrawer::drawRay(points[2], points[6], program);
+    void Octree<T>::draw(const glm::vec3& color){
+        Graphics::DebugDrawer::drawBox(_position, _dimension, color);
     }
 
     template <typename T>
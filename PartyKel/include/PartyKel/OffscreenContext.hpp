@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+namespace PartyKel {
+
+// Contexte OpenGL 3.3 core sans fenêtre ni serveur d'affichage (rendu sur une ferme de calcul), créé avec EGL:
+// plateforme "surfaceless" de Mesa si elle existe, display par défaut sinon.
+// Le contexte n'a pas de framebuffer par défaut utilisable: le rendu se fait dans un FramebufferTarget.
+// Sans EGL à la compilation (PARTYKEL_USE_EGL non défini), le constructeur lève une exception.
+class OffscreenContext {
+public:
+    OffscreenContext();
+
+    ~OffscreenContext();
+
+    OffscreenContext(const OffscreenContext&) = delete;
+
+    OffscreenContext& operator =(const OffscreenContext&) = delete;
+
+private:
+    // Handles EGL (EGLDisplay, EGLContext), opaques pour ne pas inclure EGL/egl.h ici
+    void* m_pDisplay;
+    void* m_pContext;
+};
+
+}
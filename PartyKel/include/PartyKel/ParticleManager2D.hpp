@@ -25,6 +25,12 @@ namespace PartyKel{
         glm::vec2 getForce(int i);
         float getMass(int i);
 
+        // Accès direct aux tableaux, utilisé par les intégrateurs
+        glm::vec2* getPositionArray();
+        glm::vec2* getVelocityArray();
+        glm::vec2* getForceArray();
+        const float* getMassArray() const;
+
 
         void addForceToAll(const glm::vec2& f);
         void addForce(const glm::vec2& f, int i);
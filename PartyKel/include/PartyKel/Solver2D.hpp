@@ -0,0 +1,20 @@
+#pragma once
+#include <vector>
+#include "glm/vec2.hpp"
+#include "PartyKel/AbstractForce.hpp"
+#include "PartyKel/Integrator.hpp"
+#include "PartyKel/ParticleManager2D.hpp"
+
+namespace PartyKel{
+    // Applique les forces enregistrées et fait avancer le ParticleManager2D avec l'intégrateur choisi.
+    // Les forces sont réappliquées à chaque évaluation demandée par l'intégrateur.
+    class Solver2D{
+        AbstractIntegrator<glm::vec2>* m_pIntegrator;
+        std::vector<AbstractForce*> m_forces;
+    public:
+        Solver2D(AbstractIntegrator<glm::vec2>& integrator);
+        void setIntegrator(AbstractIntegrator<glm::vec2>& integrator);
+        void addForce(AbstractForce& force);
+        void solve(ParticleManager2D& pm, float dt);
+    };
+}
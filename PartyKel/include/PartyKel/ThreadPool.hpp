@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace PartyKel{
+    // Pool de threads persistants pour paralléliser des boucles (calcul des normales, etc.)
+    // Les threads sont créés une seule fois et attendent du travail, pour qu'un appel par frame reste peu coûteux.
+    class ThreadPool{
+    public:
+        // Traite les éléments [begin, end) d'une boucle
+        typedef std::function<void(uint32_t begin, uint32_t end)> Task;
+
+        // threadCount compte le thread appelant, qui participe au travail
+        explicit ThreadPool(uint32_t threadCount = std::thread::hardware_concurrency());
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator =(const ThreadPool&) = delete;
+
+        // Découpe [0, count) en blocs d'au moins grainSize éléments répartis sur les threads.
+        // Rend la main quand tous les blocs sont traités. Une boucle trop courte est traitée sur place.
+        void parallelFor(uint32_t count, uint32_t grainSize, const Task& task);
+
+        uint32_t getThreadCount() const;
+
+        // Pool partagé par les renderers
+        static ThreadPool& getDefault();
+
+    private:
+        void workerLoop();
+        void runChunks();
+
+        std::vector<std::thread> m_workers;
+
+        std::mutex m_callMutex; // Un seul parallelFor à la fois
+        std::mutex m_mutex;
+        std::condition_variable m_wakeCondition, m_doneCondition;
+        uint64_t m_nGeneration;
+        uint32_t m_nBusyWorkers;
+        bool m_bStop;
+
+        // Boucle en cours
+        const Task* m_pTask;
+        uint32_t m_nCount, m_nChunkSize;
+        std::atomic<uint32_t> m_nNextChunk;
+    };
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "PartyKel/glm.hpp"
+#include "PartyKel/Flag.hpp"
+
+namespace PartyKel{
+    // Endort les zones immobiles du drapeau, par tuiles de tileSize x tileSize points.
+    // Une tuile dont l'énergie cinétique et la force résiduelle (forces nettes de la dernière
+    // évaluation) restent sous les seuils pendant sleepFrames frames est endormie: ses points
+    // ne reçoivent plus de forces et ne sont plus intégrés (Flag::awakeArray).
+    // Elle se réveille quand une tuile voisine bouge, qu'un collider l'atteint ou que le vent change.
+    class TileSleepController{
+        struct Tile {
+            bool awake;
+            uint32_t calmFrames;
+            glm::vec3 AABBmin, AABBmax; // boîte englobante, valable quand la tuile dort
+        };
+
+        int m_nTileSize;
+        int m_nTileCountX, m_nTileCountY;
+        std::vector<Tile> m_tiles;
+        std::vector<bool> m_movingTiles; // tuiles éveillées et agitées au début de la passe de réveil
+
+        glm::vec3 m_lastExternalForce;
+
+        float m_fEnergyThreshold;
+        float m_fForceThreshold;
+        float m_fExternalForceThreshold;
+        uint32_t m_nSleepFrames;
+
+        // Découpe la grille en tuiles éveillées si elle n'est pas déjà découpée pour ce drapeau
+        void init(const Flag& flag);
+        void setTileAwake(Flag& flag, int tileX, int tileY, bool awake);
+        // Une des 8 tuiles voisines est dans m_movingTiles
+        bool hasMovingNeighbor(int tileX, int tileY) const;
+    public:
+        TileSleepController(int tileSize = 8, float energyThreshold = 1e-5f, float forceThreshold = 5e-3f,
+                            float externalForceThreshold = 0.01f, uint32_t sleepFrames = 30);
+
+        // A appeler une fois par frame, après la simulation: endort les tuiles calmes
+        // et réveille les tuiles dormantes voisines d'une tuile en mouvement
+        void update(Flag& flag);
+
+        // Réveille les tuiles atteintes par une sphère (collider)
+        void wakeInSphere(Flag& flag, const glm::vec3& center, float radius);
+
+        // Réveille tout le drapeau si la force externe uniforme (vent, gravité) a changé
+        void notifyExternalForce(Flag& flag, const glm::vec3& F);
+
+        void wakeAll(Flag& flag);
+
+        // Oublie l'état des tuiles (à appeler quand le drapeau est recréé)
+        void reset();
+
+        uint32_t getSleepingTileCount() const;
+        uint32_t getTileCount() const;
+
+        float& energyThreshold();
+        float& forceThreshold();
+        float& externalForceThreshold();
+        uint32_t& sleepFrames();
+    };
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "PartyKel/glm.hpp"
+
+namespace PartyKel{
+    // Champ de vent cohérent dans l'espace et dans le temps: un flux moyen auquel s'ajoute une turbulence.
+    // La turbulence est un bruit de curl (donc à divergence nulle) précalculé sur une grille périodique de
+    // resolution^3 cellules de taille cellSize, qui se répète dans tout l'espace. Cette grille défile à
+    // scrollVelocity au cours du temps ("turbulence gelée" transportée par le vent).
+    // Un échantillon coûte une interpolation trilinéaire: 8 lectures dans la grille.
+    class WindField{
+        int m_nResolution; // Puissance de 2, pour replier les indices avec un simple masque
+        int m_nMask, m_nPlaneMask, m_nVolumeMask;
+        float m_fInvCellSize;
+        std::vector<glm::vec3> m_turbulence; // Moyenne quadratique de norme 1
+
+        glm::vec3 m_meanFlow;
+        float m_fTurbulence;
+        glm::vec3 m_scrollVelocity;
+
+    public:
+        WindField(const glm::vec3& meanFlow = glm::vec3(0.02f, 0.f, 0.02f), float turbulence = 0.03f,
+                  float cellSize = 1.f, int resolution = 32, uint32_t seed = 0);
+
+        // Force de vent au point position à l'instant time
+        glm::vec3 sample(const glm::vec3& position, float time) const{
+            glm::vec3 p = (position - time * m_scrollVelocity) * m_fInvCellSize;
+            // Partie entière par défaut (plus rapide que floor, qui n'est pas inliné sans SSE4.1)
+            int cx = int(p.x) - (p.x < 0.f), cy = int(p.y) - (p.y < 0.f), cz = int(p.z) - (p.z < 0.f);
+            glm::vec3 f = p - glm::vec3(cx, cy, cz);
+
+            // Indices repliés des 2 plans de la cellule selon chaque axe
+            int x0 = cx & m_nMask, x1 = (x0 + 1) & m_nMask;
+            int y0 = (cy & m_nMask) * m_nResolution, y1 = (y0 + m_nResolution) & m_nPlaneMask;
+            int z0 = (cz & m_nMask) * m_nResolution * m_nResolution, z1 = (z0 + m_nResolution * m_nResolution) & m_nVolumeMask;
+
+            const glm::vec3* v = m_turbulence.data();
+            glm::vec3 v00 = v[x0 + y0 + z0] + f.x * (v[x1 + y0 + z0] - v[x0 + y0 + z0]);
+            glm::vec3 v10 = v[x0 + y1 + z0] + f.x * (v[x1 + y1 + z0] - v[x0 + y1 + z0]);
+            glm::vec3 v01 = v[x0 + y0 + z1] + f.x * (v[x1 + y0 + z1] - v[x0 + y0 + z1]);
+            glm::vec3 v11 = v[x0 + y1 + z1] + f.x * (v[x1 + y1 + z1] - v[x0 + y1 + z1]);
+
+            glm::vec3 v0 = v00 + f.y * (v10 - v00);
+            glm::vec3 v1 = v01 + f.y * (v11 - v01);
+            return m_meanFlow + m_fTurbulence * (v0 + f.z * (v1 - v0));
+        }
+
+        // Echantillonne count positions d'un coup (plusieurs drapeaux peuvent partager le même champ)
+        void sample(const glm::vec3* positions, uint32_t count, float time, glm::vec3* forces) const;
+
+        int getResolution() const;
+        float getCellSize() const;
+
+        glm::vec3& meanFlow();
+        float& turbulence();
+        glm::vec3& scrollVelocity();
+    };
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <map>
+
+namespace PartyKel {
+
+// Grand buffer OpenGL partagé par plusieurs maillages: chaque maillage y réserve une zone (sommets ou indices)
+// au lieu de créer son propre buffer. Tous les maillages d'un même format sont alors dessinés avec un seul VAO,
+// en donnant la position de leur zone aux draws "base vertex" (glDrawElementsBaseVertex, draws indirects).
+//
+// Les zones libres sont gardées triées et fusionnées quand elles se touchent (first fit).
+// Si aucune zone libre n'est assez grande, le buffer est agrandi (copie du contenu dans un nouveau buffer):
+// les offsets restent valides mais l'identifiant du buffer change, les VAOs doivent alors être mis à jour (voir getGeneration).
+class BufferArena {
+public:
+    struct Allocation {
+        GLintptr offset; // En octets
+        GLsizeiptr size;
+
+        Allocation(): offset(0), size(0) {}
+        Allocation(GLintptr offset, GLsizeiptr size): offset(offset), size(size) {}
+
+        bool isValid() const {
+            return size > 0;
+        }
+
+        // Indice du premier élément de la zone, pour des éléments de elementSize octets
+        // (baseVertex avec la taille d'un sommet, firstIndex avec la taille d'un indice)
+        GLint firstElement(GLsizei elementSize) const {
+            return GLint(offset / elementSize);
+        }
+    };
+
+    BufferArena(GLsizeiptr capacity, GLenum usage = GL_STATIC_DRAW);
+
+    ~BufferArena();
+
+    BufferArena(const BufferArena&) = delete;
+
+    BufferArena& operator =(const BufferArena&) = delete;
+
+    // Réserve size octets à un offset multiple de alignment (la taille d'un sommet pour les draws base vertex),
+    // un alignment inférieur à 1 est traité comme 1
+    Allocation allocate(GLsizeiptr size, GLsizeiptr alignment);
+
+    void free(const Allocation& allocation);
+
+    // Écrit size octets dans la zone, à partir de offset octets du début de la zone
+    void upload(const Allocation& allocation, const void* data, GLsizeiptr size, GLintptr offset = 0);
+
+    GLuint getBufferID() const {
+        return m_BufferID;
+    }
+
+    // Incrémenté à chaque agrandissement du buffer (changement de getBufferID)
+    uint32_t getGeneration() const {
+        return m_nGeneration;
+    }
+
+    GLsizeiptr getCapacity() const {
+        return m_nCapacity;
+    }
+
+    GLsizeiptr getUsedSize() const {
+        return m_nUsedSize;
+    }
+
+private:
+    void grow(GLsizeiptr minCapacity);
+    void addFreeRange(GLintptr offset, GLsizeiptr size);
+
+    GLuint m_BufferID;
+    GLenum m_Usage;
+    GLsizeiptr m_nCapacity, m_nUsedSize;
+    uint32_t m_nGeneration;
+
+    // Zones libres: offset -> taille
+    std::map<GLintptr, GLsizeiptr> m_FreeRanges;
+};
+
+}
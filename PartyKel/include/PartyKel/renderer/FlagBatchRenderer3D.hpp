@@ -0,0 +1,129 @@
+#pragma once
+
+#include "PartyKel/glm.hpp"
+#include "PartyKel/renderer/BufferArena.hpp"
+#include "PartyKel/renderer/PackedVertex.hpp"
+#include "PartyKel/renderer/StreamBuffer.hpp"
+#include <GL/glew.h>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace PartyKel {
+
+// Rendu d'un grand nombre de drapeaux en un seul appel.
+// Les sommets (position et normale) de tous les drapeaux sont écrits à la suite dans un seul StreamBuffer,
+// et les indices d'une même résolution de grille ne sont stockés qu'une fois (BufferArena).
+// Si le driver le permet (GL 4.3 / ARB_multi_draw_indirect), tous les drapeaux sont dessinés par un seul
+// glMultiDrawElementsIndirect: une commande par drapeau (zone d'indices de sa grille, premier sommet du drapeau),
+// écrites une fois pour toutes dans un buffer et réécrites seulement quand la liste des drapeaux change.
+// Un appel par type d'indices au plus: les grilles de plus de 65536 points ont des indices sur 32 bits.
+// Le baseInstance de chaque commande est l'indice du drapeau (boîte englobante du format compressé).
+// Sinon, un glDrawElementsBaseVertex par drapeau, sans changement d'état entre les draws.
+//
+// Les matrices de la caméra sont lues dans le bloc Camera: Graphics::CameraUniformBuffer doit être mis à jour avant les draws
+class FlagBatchRenderer3D {
+	struct Vertex {
+		glm::vec3 position;
+		glm::vec3 normal;
+	};
+
+	// Format imposé par glMultiDrawElementsIndirect
+	struct DrawElementsIndirectCommand {
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	// Indices partagés par tous les drapeaux d'une même résolution (voir GridIndexBuffer)
+	struct GridPattern {
+		BufferArena::Allocation indices;
+		GLuint indexCount;
+		GLenum indexType;
+	};
+
+	struct FlagEntry {
+		int gridWidth, gridHeight;
+		const GridPattern* pPattern;
+		GLint baseVertex; // Premier sommet du drapeau dans les données d'une frame
+	};
+public:
+    FlagBatchRenderer3D(bool allowMultiDrawIndirect = true);
+
+    ~FlagBatchRenderer3D();
+
+    FlagBatchRenderer3D(const FlagBatchRenderer3D&) = delete;
+
+    FlagBatchRenderer3D& operator =(const FlagBatchRenderer3D&) = delete;
+
+    // Ajoute un drapeau de gridWidth * gridHeight points et renvoie son indice (ordre des tableaux de drawFlags)
+    uint32_t addFlag(int gridWidth, int gridHeight);
+
+    // Retire tous les drapeaux (les indices des résolutions déjà rencontrées sont conservés)
+    void removeFlags();
+
+    uint32_t getFlagCount() const {
+        return m_Flags.size();
+    }
+
+	void clear();
+
+	// positionArrays[i] contient les positions du drapeau i (dans l'ordre des addFlag).
+	// Si visibleFlags n'est pas vide, seuls les drapeaux i tels que visibleFlags[i] vaut 1 sont calculés, envoyés et dessinés
+	// (voir Flag::computeVisiblePatches)
+	void drawFlags(const std::vector<const glm::vec3*>& positionArrays, bool wireframe,
+	               const std::vector<uint8_t>& visibleFlags = std::vector<uint8_t>());
+
+    bool usesMultiDrawIndirect() const {
+        return m_bMultiDrawIndirect;
+    }
+
+    // Format des sommets envoyés à chaque frame. PACKED_VERTICES divise par 2 la taille des données,
+    // la boîte englobante de chaque drapeau (24 octets) est envoyée en plus
+    void setVertexFormat(FlagVertexFormat format) {
+        m_VertexFormat = format;
+    }
+
+    FlagVertexFormat getVertexFormat() const {
+        return m_VertexFormat;
+    }
+
+private:
+    const GridPattern& getGridPattern(int gridWidth, int gridHeight);
+    void uploadCommands(const std::vector<uint8_t>& visibleFlags);
+
+    // Écrivent les sommets d'un drapeau, normales comprises
+    static void writeVertices(const glm::vec3* positionArray, int gridWidth, int gridHeight, Vertex* pVertices);
+    static void writePackedVertices(const glm::vec3* positionArray, int gridWidth, int gridHeight,
+                                    PackedFlagVertex* pVertices, PackedFlagBox& box);
+
+	static const GLchar *VERTEX_SHADER, *FRAGMENT_SHADER, *PACKED_VERTEX_SHADER;
+
+    // Ressources OpenGL
+    GLuint m_ProgramID, m_PackedProgramID;
+    GLuint m_VAOID;
+    GLuint m_CommandBufferID;
+
+    bool m_bMultiDrawIndirect;
+
+    // Indices de toutes les résolutions de grille, l'index buffer du VAO est mis à jour si l'arène est agrandie
+    BufferArena m_IndexArena;
+    uint32_t m_nIndexArenaGeneration;
+    std::map<std::pair<int, int>, GridPattern> m_GridPatterns;
+
+    std::vector<FlagEntry> m_Flags;
+    uint32_t m_nVertexCount;
+    bool m_bCommandsDirty;
+    std::vector<uint8_t> m_CommandVisibility; // Visibilité écrite dans le buffer de commandes (vide: tous visibles)
+    std::vector<DrawElementsIndirectCommand> m_Commands;
+    GLsizei m_nShortCommandCount; // Commandes des grilles à indices 16 bits, placées en tête du buffer
+
+    // Sommets de tous les drapeaux envoyés à chaque frame, 3 frames d'avance
+    FlagVertexFormat m_VertexFormat;
+    std::vector<PackedFlagBox> m_FlagBoxes;
+    StreamBuffer m_VertexStream;
+};
+
+}
@@ -1,11 +1,16 @@
 #pragma once
 
 #include "PartyKel/glm.hpp"
+#include "PartyKel/GridPatch.hpp"
+#include "PartyKel/renderer/PackedVertex.hpp"
+#include "PartyKel/renderer/StreamBuffer.hpp"
 #include <GL/glew.h>
+#include <mutex>
 #include <vector>
 
 namespace PartyKel {
 
+// Les matrices de la caméra sont lues dans le bloc Camera: Graphics::CameraUniformBuffer doit être mis à jour avant les draws
 class FlagRenderer3D {
 	struct Vertex {
 		glm::vec3 position;
@@ -24,30 +29,115 @@ public:
 
 	void drawGrid(const glm::vec3* positionArray, bool wireframe);
 
-    void setProjMatrix(const glm::mat4& P) {
-		m_ProjMatrix = P;
+	// Variante utilisant les normales des triangles déjà calculées par la simulation
+	// (voir Flag::triangleNormalArray): chaque normale de sommet est la somme de celles des triangles adjacents
+	void drawGrid(const glm::vec3* positionArray, const glm::vec3* triangleNormalArray, bool wireframe);
+
+	// Variantes recevant la boîte englobante des positions, déjà tenue à jour par la simulation (Flag::getAABB):
+	// elle sert de référence aux positions compressées (PACKED_VERTICES) sans parcourir la grille une fois de plus
+	void drawGrid(const glm::vec3* positionArray, const glm::vec3& AABBmin, const glm::vec3& AABBmax, bool wireframe);
+	void drawGrid(const glm::vec3* positionArray, const glm::vec3* triangleNormalArray,
+	              const glm::vec3& AABBmin, const glm::vec3& AABBmax, bool wireframe);
+
+	// Variante n'envoyant que les positions (buffer texture): les normales sont calculées
+	// dans le vertex shader à partir des voisins sur la grille
+	void drawGridGPUNormals(const glm::vec3* positionArray, bool wireframe);
+
+	// Format des sommets envoyés par les deux variantes de drawGrid (normales calculées sur le CPU).
+	// PACKED_VERTICES divise par 2 la taille des données envoyées à chaque frame
+	void setVertexFormat(FlagVertexFormat format) {
+		m_VertexFormat = format;
 	}
 
-    void setViewMatrix(const glm::mat4& V) {
-		m_ViewMatrix = V;
+	FlagVertexFormat getVertexFormat() const {
+		return m_VertexFormat;
 	}
 
+	// Carrés de la grille à dessiner (voir Flag::computeVisiblePatches), pour les draws suivants: les sommets
+	// des carrés invisibles et de leurs voisins ne sont ni calculés ni envoyés. Vide: toute la grille
+	void setVisiblePatches(const std::vector<uint8_t>& visiblePatches);
+
 private:
-	static const GLchar *VERTEX_SHADER, *FRAGMENT_SHADER;
+    // Calcul des normales en plusieurs passes parallélisées par lignes de la grille, ou par carrés avec le culling
+    // (voir FlagRenderer3D.cpp). Chaque passe traite les lignes [rowBegin, rowEnd[ et les colonnes [columnBegin, columnEnd[
+    // de points ou de cases
+    void copyPositions(const glm::vec3* positionArray, uint32_t rowBegin, uint32_t rowEnd, uint32_t columnBegin, uint32_t columnEnd);
+    void computeTriangleNormals(uint32_t rowBegin, uint32_t rowEnd, uint32_t columnBegin, uint32_t columnEnd);
+    void copyTriangleNormals(const glm::vec3* triangleNormalArray, uint32_t rowBegin, uint32_t rowEnd, uint32_t columnBegin, uint32_t columnEnd);
+    void gatherVertexNormals(uint32_t rowBegin, uint32_t rowEnd, uint32_t columnBegin, uint32_t columnEnd);
+
+    // Variantes de drawGrid: triangleNormalArray et pBox peuvent être nuls (normales des triangles calculées ici,
+    // boîte calculée pendant copyPositions)
+    void drawGridCPUNormals(const glm::vec3* positionArray, const glm::vec3* triangleNormalArray,
+                            const PackedFlagBox* pBox, bool wireframe);
+
+    // Appelle pass(rowBegin, rowEnd, columnBegin, columnEnd) sur les points de toute la grille,
+    // ou sur ceux des carrés à level + 1 carrés au plus d'un carré visible (m_PassPatches[level])
+    template<typename Pass>
+    void forEachRegion(int level, const Pass& pass);
+
+    // Draw de toute la grille ou des carrés visibles
+    void drawElements();
+
+    // Réserve les sommets de la frame dans m_VertexStream (m_pVertices ou m_pPackedVertices selon le format)
+    void mapVertices();
+
+    // Dessine les sommets écrits dans m_pVertices ou m_pPackedVertices
+    void draw(bool wireframe);
+
+	static const GLchar *VERTEX_SHADER, *FRAGMENT_SHADER, *GPU_NORMALS_VERTEX_SHADER, *PACKED_VERTEX_SHADER;
 
     // Ressources OpenGL
     GLuint m_ProgramID;
-    GLuint m_VBOID, m_VAOID, m_IBOID;
+    GLuint m_VAOID, m_IBOID;
 
-    GLint m_uMVPMatrix, m_uMVMatrix;
+    // Ressources du calcul des normales sur le GPU
+    GLuint m_GPUNormalsProgramID;
+    GLuint m_PositionTextureID, m_GPUNormalsVAOID;
+    GLint m_uGPUNormalsFirstPosition;
 
-    glm::mat4 m_ProjMatrix;
-    glm::mat4 m_ViewMatrix;
+    // Programme des sommets compressés
+    GLuint m_PackedProgramID;
+    GLint m_uPackedBoxMin, m_uPackedBoxSize;
 
     int m_nGridWidth, m_nGridHeight;
     uint32_t m_nIndexCount;
-
-    std::vector<Vertex> m_VertexBuffer;
+    GLenum m_IndexType; // GL_UNSIGNED_SHORT si la grille le permet
+    GLsizei m_nIndexSize;
+
+    // Carrés de la grille, dans l'ordre de Flag::patchArray, et leurs indices
+    std::vector<GridPatch> m_Patches;
+    int m_nPatchColumnCount, m_nPatchRowCount;
+    std::vector<GLsizei> m_PatchFirstIndices, m_PatchIndexCounts;
+
+    // Culling: zones d'indices des carrés visibles et carrés traités par chaque niveau de passe
+    bool m_bCulling;
+    std::vector<const GLvoid*> m_VisibleFirstIndices;
+    std::vector<GLsizei> m_VisibleIndexCounts;
+    std::vector<uint32_t> m_PassPatches[3];
+
+    // Sommets (position et normale) ou positions seules envoyés à chaque frame, 3 frames d'avance.
+    // Les passes de calcul des normales écrivent directement dans m_pVertices (ou m_pPackedVertices), zone mappée de m_VertexStream
+    StreamBuffer m_VertexStream, m_PositionStream;
+    FlagVertexFormat m_VertexFormat;
+    Vertex* m_pVertices;
+    PackedFlagVertex* m_pPackedVertices;
+
+    // Boîte englobante des positions de la frame (référence des positions compressées): fournie par l'appelant,
+    // ou calculée pendant copyPositions si m_bComputeBox
+    bool m_bComputeBox;
+    glm::vec3 m_BoxMin, m_BoxMax;
+    std::mutex m_BoxMutex;
+    PackedFlagBox m_Box;
+
+    // Positions en SoA (x, y, z séparés) pour traiter plusieurs points par instruction
+    std::vector<float> m_PositionX, m_PositionY, m_PositionZ;
+
+    // Normales (non normalisées) des 2 triangles de chaque case, en SoA, sur une grille de cases bordée
+    // d'une case nulle de chaque côté: un sommet lit toujours ses 4 cases voisines, sans test de bord
+    int m_nPaddedWidth;
+    std::vector<float> m_Triangle0X, m_Triangle0Y, m_Triangle0Z;
+    std::vector<float> m_Triangle1X, m_Triangle1Y, m_Triangle1Z;
 };
 
 }
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace PartyKel {
+
+// Enregistre les images rendues dans une suite de fichiers PPM sans ralentir la boucle de rendu.
+// La lecture des pixels passe par 2 pixel buffer objects utilisés à tour de rôle: capture() lance la copie
+// du framebuffer courant dans l'un (glReadPixels asynchrone, le CPU n'attend pas le GPU) et récupère l'image
+// de l'appel précédent dans l'autre, que le GPU a eu une frame pour copier.
+// Les pixels récupérés sont confiés à un thread qui encode et écrit les fichiers: capture() n'attend jamais le disque,
+// les images en retard s'accumulent en mémoire (getPendingFrameCount).
+//
+// Utilisation: capture() après les draws de chaque frame, le framebuffer à lire étant lié (FramebufferTarget::bind),
+// puis finish() (ou le destructeur) pour écrire la dernière image
+class FrameCapture {
+public:
+    // filePattern: chemin au format printf recevant le numéro de l'image, par exemple "frames/flag_%05d.ppm".
+    // Lance std::runtime_error s'il ne contient pas exactement une conversion entière (d, i, u, o, x ou X)
+    FrameCapture(GLsizei width, GLsizei height, const std::string& filePattern);
+
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+
+    FrameCapture& operator =(const FrameCapture&) = delete;
+
+    // Capture les width * height pixels du framebuffer lu (GL_READ_FRAMEBUFFER)
+    void capture();
+
+    // Récupère la dernière image capturée et attend que toutes les images soient écrites
+    void finish();
+
+    uint32_t getCapturedFrameCount() const {
+        return m_nFrameCount;
+    }
+
+    // Images récupérées dont l'écriture n'est pas terminée
+    uint32_t getPendingFrameCount() const;
+
+private:
+    struct Frame {
+        uint32_t index;
+        std::vector<uint8_t> pixels; // RGBA, lignes de bas en haut (ordre de glReadPixels)
+    };
+
+    // Copie l'image index depuis son PBO et la confie au thread d'écriture
+    void retrieve(uint32_t index);
+
+    void writerLoop();
+    void writeFrame(const Frame& frame) const;
+
+    GLsizei m_nWidth, m_nHeight;
+    std::string m_FilePattern;
+
+    GLuint m_PBOIDs[2];
+    uint32_t m_nFrameCount; // Images dont la lecture a été lancée
+    uint32_t m_nRetrievedCount; // Images copiées depuis leur PBO
+
+    // Thread d'écriture
+    std::thread m_writer;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wakeCondition, m_doneCondition;
+    std::deque<Frame> m_queue;
+    std::vector<std::vector<uint8_t>> m_freeBuffers; // Buffers des images écrites, réutilisés
+    uint32_t m_nWritingCount;
+    bool m_bStop;
+};
+
+}
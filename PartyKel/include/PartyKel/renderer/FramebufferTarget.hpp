@@ -0,0 +1,45 @@
+#pragma once
+
+#include <GL/glew.h>
+
+namespace PartyKel {
+
+// Cible de rendu hors écran: framebuffer de width * height pixels (couleur RGBA8, profondeur 24 bits).
+// Fonctionne avec tout contexte OpenGL 3.3, y compris sans framebuffer par défaut (OffscreenContext, OSMesa).
+//
+// Utilisation: bind(); (draws); puis lecture des pixels (FrameCapture) tant que la cible est liée
+class FramebufferTarget {
+public:
+    FramebufferTarget(GLsizei width, GLsizei height);
+
+    ~FramebufferTarget();
+
+    FramebufferTarget(const FramebufferTarget&) = delete;
+
+    FramebufferTarget& operator =(const FramebufferTarget&) = delete;
+
+    // Lie le framebuffer en lecture et écriture et règle le viewport sur sa taille
+    void bind();
+
+    // Revient au framebuffer par défaut
+    void unbind();
+
+    GLuint getFramebufferID() const {
+        return m_FramebufferID;
+    }
+
+    GLsizei getWidth() const {
+        return m_nWidth;
+    }
+
+    GLsizei getHeight() const {
+        return m_nHeight;
+    }
+
+private:
+    GLsizei m_nWidth, m_nHeight;
+    GLuint m_FramebufferID;
+    GLuint m_ColorRenderbufferID, m_DepthRenderbufferID;
+};
+
+}
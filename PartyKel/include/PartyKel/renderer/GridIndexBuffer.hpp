@@ -0,0 +1,50 @@
+#pragma once
+
+#include "PartyKel/GridPatch.hpp"
+#include <GL/glew.h>
+#include <vector>
+
+namespace PartyKel {
+
+// Indices des triangles d'une grille de gridWidth * gridHeight points (le point (i, j) est le sommet i + j * gridWidth),
+// deux triangles par case: A B C puis A C D avec A = (i, j), B = (i+1, j), C = (i+1, j+1), D = (i, j+1).
+//
+// Les cases ne sont pas parcourues ligne par ligne sur toute la largeur: pour une grille large, les sommets
+// d'une ligne sont sortis du cache post-transformation du GPU avant d'être réutilisés par la ligne suivante,
+// et chaque sommet passe 2 fois dans le vertex shader. La grille est découpée en bandes verticales de
+// blockWidth cases, parcourues ligne par ligne: une ligne de la bande réutilise les blockWidth + 1 sommets
+// du haut de la ligne précédente, encore dans le cache tant que celui-ci contient 2 * (blockWidth + 1) sommets.
+//
+// Les indices d'un carré de blockWidth x blockWidth cases (voir buildGridPatches) sont contigus: les carrés peuvent
+// être dessinés séparément (patchFirstIndices, patchIndexCounts), par exemple pour n'afficher que ceux qui sont visibles.
+//
+// Les indices sont sur 16 bits si tous les sommets de la grille sont adressables ainsi, sur 32 bits sinon.
+struct GridIndexBuffer {
+    // Nombre de cases par bande: 2 * 16 sommets pour un cache FIFO de 32 entrées (valeur prudente)
+    static const int DEFAULT_BLOCK_WIDTH = GRID_PATCH_QUADS;
+
+    GLenum type; // GL_UNSIGNED_SHORT ou GL_UNSIGNED_INT
+    GLsizei count;
+    std::vector<GLushort> shortIndices;
+    std::vector<GLuint> intIndices;
+
+    // Premier indice et nombre d'indices de chaque carré de buildGridPatches(gridWidth, gridHeight, blockWidth)
+    std::vector<GLsizei> patchFirstIndices, patchIndexCounts;
+
+    GridIndexBuffer(int gridWidth, int gridHeight, int blockWidth = DEFAULT_BLOCK_WIDTH);
+
+    const GLvoid* data() const {
+        return type == GL_UNSIGNED_SHORT ? (const GLvoid*) shortIndices.data() : (const GLvoid*) intIndices.data();
+    }
+
+    // Taille d'un indice en octets
+    GLsizei indexSize() const {
+        return type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    }
+
+    GLsizeiptr byteSize() const {
+        return GLsizeiptr(count) * indexSize();
+    }
+};
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "PartyKel/glm.hpp"
+#include <vector>
+
+namespace PartyKel {
+
+// Surface lisse de fineWidth * fineHeight points évaluée sur une grille grossière de coarseWidth * coarseHeight points,
+// par exemple les positions d'un drapeau simulé à basse résolution: la simulation garde son coût, seul le rendu
+// (FlagRenderer3D construit à la résolution fine) traite la grille fine.
+//
+// Surface bicubique de Catmull-Rom (Geometry::cubicInterpolation dans chaque direction): elle passe par les points
+// de la grille grossière, le bord fixé du drapeau reste donc en place. Les points manquants au bord de la grille
+// sont extrapolés linéairement (p(-1) = 2 p(0) - p(1)).
+//
+// Le produit tensoriel est évalué en 2 passes: chaque ligne grossière est interpolée en x (fineWidth * coarseHeight
+// points, en SoA), puis chaque ligne fine est une combinaison de 4 de ces lignes, 4 points par instruction.
+class GridSubdivider {
+public:
+    GridSubdivider(int coarseWidth, int coarseHeight, int fineWidth, int fineHeight);
+
+    // Évalue la surface à partir des coarseWidth * coarseHeight positions et renvoie les fineWidth * fineHeight
+    // positions fines (le point (i, j) est i + j * fineWidth), valides jusqu'à l'appel suivant
+    const glm::vec3* subdivide(const glm::vec3* coarsePositionArray);
+
+    int getFineWidth() const {
+        return m_nFineWidth;
+    }
+
+    int getFineHeight() const {
+        return m_nFineHeight;
+    }
+
+private:
+    // Point fin = somme des weights[k] * point grossier first + k (weight nul au-delà de la grille)
+    struct Stencil {
+        int first;
+        float weights[4];
+    };
+
+    static std::vector<Stencil> buildStencils(int coarseCount, int fineCount);
+
+    void interpolateRows(const glm::vec3* coarsePositionArray, uint32_t rowBegin, uint32_t rowEnd);
+    void interpolateColumns(uint32_t rowBegin, uint32_t rowEnd);
+
+    int m_nCoarseWidth, m_nCoarseHeight;
+    int m_nFineWidth, m_nFineHeight;
+    std::vector<Stencil> m_ColumnStencils, m_RowStencils;
+
+    // Lignes grossières interpolées en x (fineWidth * coarseHeight points)
+    std::vector<float> m_RowX, m_RowY, m_RowZ;
+
+    std::vector<glm::vec3> m_FinePositions;
+};
+
+}
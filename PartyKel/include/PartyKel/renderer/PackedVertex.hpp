@@ -0,0 +1,78 @@
+#pragma once
+
+#include "PartyKel/glm.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace PartyKel {
+
+// Format des sommets des drapeaux envoyés à chaque frame
+enum FlagVertexFormat {
+    FLOAT_VERTICES, // Position et normale en flottants: 24 octets par sommet
+    PACKED_VERTICES // PackedFlagVertex: 12 octets par sommet
+};
+
+// Sommet compressé:
+// - position sur 3 x 16 bits, relative à la boîte englobante du drapeau (0 = min, 65535 = max de la boîte)
+// - normale en projection octaédrique sur 2 x 16 bits signés
+// La décompression est faite dans le vertex shader (PACKED_VERTEX_GLSL)
+struct PackedFlagVertex {
+    GLushort position[4]; // Le 4ème composant n'est pas utilisé (alignement)
+    GLshort normal[2];
+
+    // Attributs: position en GL_UNSIGNED_SHORT normalisé, normale en GL_SHORT normalisé
+    static void setAttribPointers(GLuint positionLocation, GLuint normalLocation, GLintptr offset) {
+        glVertexAttribPointer(positionLocation, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedFlagVertex),
+                              (const GLvoid*) (offset + offsetof(PackedFlagVertex, position)));
+        glVertexAttribPointer(normalLocation, 2, GL_SHORT, GL_TRUE, sizeof(PackedFlagVertex),
+                              (const GLvoid*) (offset + offsetof(PackedFlagVertex, normal)));
+    }
+};
+
+// Boîte englobante d'un drapeau, dans le format attendu par le vertex shader
+struct PackedFlagBox {
+    glm::vec3 min;
+    glm::vec3 size;
+
+    PackedFlagBox(): min(0.f), size(0.f) {}
+
+    PackedFlagBox(const glm::vec3& min, const glm::vec3& max): min(min), size(max - min) {}
+
+    // Position quantifiée dans la boîte: une boîte plate dans une direction donne 0
+    void packPosition(const glm::vec3& position, GLushort* packed) const {
+        for(int c = 0; c < 3; ++c) {
+            float t = size[c] > 0.f ? (position[c] - min[c]) / size[c] : 0.f;
+            packed[c] = GLushort(std::lround(glm::clamp(t, 0.f, 1.f) * 65535.f));
+        }
+        packed[3] = 0;
+    }
+};
+
+// Projection octaédrique d'une normale normalisée: la normale est projetée sur l'octaèdre |x| + |y| + |z| = 1,
+// dont la moitié z < 0 est repliée sur les coins du carré [-1, 1]^2. Une normale nulle donne (0, 0, 1) au décodage
+inline void packNormal(const glm::vec3& normal, GLshort* packed) {
+    float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    glm::vec2 e = l1 > 0.f ? glm::vec2(normal.x, normal.y) / l1 : glm::vec2(0.f);
+    if(normal.z < 0.f) {
+        e = glm::vec2((1.f - std::abs(e.y)) * (e.x >= 0.f ? 1.f : -1.f),
+                      (1.f - std::abs(e.x)) * (e.y >= 0.f ? 1.f : -1.f));
+    }
+    packed[0] = GLshort(std::lround(glm::clamp(e.x, -1.f, 1.f) * 32767.f));
+    packed[1] = GLshort(std::lround(glm::clamp(e.y, -1.f, 1.f) * 32767.f));
+}
+
+}
+
+// Fonctions GLSL de décompression d'un PackedFlagVertex (attributs normalisés par OpenGL dans [0, 1] et [-1, 1])
+#define PACKED_VERTEX_GLSL \
+    "vec3 unpackPosition(vec3 packedPosition, vec3 boxMin, vec3 boxSize) {\n" \
+    "    return boxMin + packedPosition * boxSize;\n" \
+    "}\n" \
+    "vec3 unpackNormal(vec2 e) {\n" \
+    "    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n" \
+    "    if(n.z < 0.0)\n" \
+    "        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);\n" \
+    "    return normalize(n);\n" \
+    "}\n"
@@ -2,6 +2,7 @@
 
 #include <GL/glew.h>
 #include "PartyKel/glm.hpp"
+#include "PartyKel/renderer/StreamBuffer.hpp"
 
 namespace PartyKel {
 
@@ -44,14 +45,15 @@ private:
     GLuint m_ProgramID, m_PolygonProgramID, m_LineProgramID;
     GLuint m_VBOID, m_VAOID;
 
-    GLuint m_PolygonVBOID, m_PolygonVAOID;
+    GLuint m_PolygonVAOID, m_LineVAOID;
 
-    GLuint m_LinePositionVBOID, m_LineColorVBOID, m_LineIBOID, m_LineVAOID;
+    // Données envoyées à chaque draw
+    StreamBuffer m_PolygonStream;
+    StreamBuffer m_LinePositionStream, m_LineColorStream, m_LineIndexStream;
+    StreamBuffer m_ParticlePositionStream, m_ParticleMassStream, m_ParticleColorStream;
 
     // Uniform locations
-    GLint m_uParticleColor;
-    GLint m_uParticlePosition;
-    GLint m_uParticleScale;
+    GLint m_uMassScale;
 
     GLint m_uPolygonColor;
 };
@@ -3,11 +3,22 @@
 #include "PartyKel/glm.hpp"
 #include <GL/glew.h>
 #include <vector>
+#include "graphics/VertexBufferObject.h"
 
 namespace PartyKel {
 
+// Les matrices de la caméra sont lues dans le bloc Camera: Graphics::CameraUniformBuffer doit être mis à jour avant les draws
 class Renderer3D {
 public:
+    // Représentation des sphères:
+    // - SPHERE_MESH: maillage de la Sphere (32x32), instancié
+    // - SPHERE_IMPOSTOR: un carré face à la caméra par sphère, lancer de rayon dans le fragment shader
+    //   (profondeur et normale exactes au pixel, 4 sommets par sphère)
+    enum SphereMode {
+        SPHERE_MESH,
+        SPHERE_IMPOSTOR
+    };
+
     Renderer3D();
 
     ~Renderer3D();
@@ -24,28 +35,37 @@ public:
                        const glm::vec3* colorArray,
                        float massScale = 0.05);
 
-    void setProjMatrix(const glm::mat4& P) {
-        m_ProjMatrix = P;
+    void setSphereMode(SphereMode mode) {
+        m_SphereMode = mode;
     }
 
-    void setViewMatrix(const glm::mat4& V) {
-        m_ViewMatrix = V;
+    SphereMode getSphereMode() const {
+        return m_SphereMode;
     }
 
 private:
     static const GLchar *SPHERE_VERTEX_SHADER, *SPHERE_FRAGMENT_SHADER;
+    static const GLchar *IMPOSTOR_VERTEX_SHADER, *IMPOSTOR_FRAGMENT_SHADER;
 
     // Ressources OpenGL
-    GLuint m_SphereProgramID;
+    GLuint m_SphereProgramID, m_ImpostorProgramID;
     GLuint m_SphereVBOID, m_SphereVAOID;
+    GLuint m_ImpostorVBOID, m_ImpostorVAOID;
+
+    SphereMode m_SphereMode;
 
     uint32_t m_nSphereVertexCount;
 
-    glm::mat4 m_ProjMatrix;
-    glm::mat4 m_ViewMatrix;
+    // Attributs d'instance des sphères, et copie de ce qui est dans les VBOs
+    Graphics::VertexBufferObject m_InstancePositionVBO, m_InstanceColorVBO, m_InstanceScaleVBO;
+    std::vector<glm::vec3> m_InstancePositions, m_InstanceColors;
+    std::vector<float> m_InstanceScales;
+    std::vector<float> m_NewInstanceScales;
 
-    GLint m_uMVPMatrix, m_uMVMatrix;
-    GLint m_uParticleColor;
+    // Envoie data dans vbo: tout si le nombre d'instances a changé, sinon seulement l'intervalle modifié
+    template <typename T>
+    static void updateInstanceData(Graphics::VertexBufferObject& vbo, std::vector<T>& uploaded,
+                                   const T* data, uint32_t count);
 };
 
 }
@@ -45,6 +45,10 @@ struct SphereHandler{
     std::vector<glm::vec3> positions;
     std::vector<glm::vec3> colors;
     std::vector<float> radius;
+
+    // Copie dans visibleSpheres les sphères dont la boîte englobante est visible par la matrice MVP
+    // (Geometry::Frustum::cull), pour n'envoyer et ne dessiner qu'elles
+    void getVisibleSpheres(const glm::mat4& MVP, SphereHandler& visibleSpheres) const;
 };
     
 }
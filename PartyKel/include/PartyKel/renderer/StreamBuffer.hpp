@@ -0,0 +1,74 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace PartyKel {
+
+// Buffer OpenGL pour les données envoyées à chaque frame (positions du drapeau, lignes, ...).
+// Si le driver le permet (GL 4.4 / ARB_buffer_storage), le buffer est mappé une fois pour toutes
+// (mapping persistant et cohérent) et utilisé comme un anneau: map() renvoie directement une zone de la
+// mémoire du buffer, qui n'est réécrite qu'une fois que le GPU a fini de lire ce qui s'y trouvait (fences).
+// Avec une capacité de 3 fois la taille des données d'une frame (triple buffering), le CPU n'attend jamais le GPU.
+// Sinon, map() renvoie une zone de la mémoire centrale envoyée par unmap() dans un buffer orphelin
+// (glBufferData sans données puis glBufferSubData), ce qui évite aussi la synchronisation implicite.
+//
+// Utilisation: data = map(size); (écriture des données); offset = unmap(); (draws lisant getBufferID() à offset)
+// Les draws doivent être émis avant le map() suivant ou un appel à fence().
+class StreamBuffer {
+public:
+    // Capacité initiale: regionCount zones de size octets (le buffer est agrandi si besoin)
+    StreamBuffer(GLsizeiptr size, uint32_t regionCount = 3, bool allowPersistentMapping = true);
+
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+
+    StreamBuffer& operator =(const StreamBuffer&) = delete;
+
+    // Réserve size octets et renvoie l'adresse où les écrire
+    void* map(GLsizeiptr size);
+
+    // Termine l'écriture et renvoie la position des données dans le buffer, en octets
+    GLintptr unmap();
+
+    // Protège les dernières données envoyées jusqu'à ce que les draws déjà émis soient exécutés
+    void fence();
+
+    // Peut changer si le buffer doit être agrandi
+    GLuint getBufferID() const {
+        return m_BufferID;
+    }
+
+    bool isPersistent() const {
+        return m_bPersistent;
+    }
+
+private:
+    struct Fence {
+        GLsync sync;
+        GLintptr begin, end;
+    };
+
+    void allocate(GLsizeiptr capacity);
+    void release();
+    void waitForRange(GLintptr begin, GLintptr end);
+
+    GLuint m_BufferID;
+    GLsizeiptr m_nCapacity;
+    bool m_bPersistent;
+
+    // Mapping persistant
+    char* m_pMappedData;
+    GLintptr m_nHead; // Début de la prochaine zone libre
+    GLintptr m_nMappedBegin, m_nMappedEnd; // Zone du dernier map()
+    bool m_bUnfenced; // La zone du dernier map() n'est pas encore protégée par une fence
+    std::deque<Fence> m_Fences;
+
+    // Copie en mémoire centrale utilisée sans mapping persistant
+    std::vector<char> m_StagingData;
+};
+
+}
@@ -30,6 +30,11 @@ public:
 		return V;
 	}
 
+	// Position de la caméra dans le repère monde
+	glm::vec3 getPosition() const {
+		return glm::vec3(glm::inverse(getViewMatrix())[3]);
+	}
+
 private:
 	float m_fDistance;
 	float m_fAngleX, m_fAngleY;
@@ -0,0 +1,59 @@
+#include "PartyKel/AdaptiveTimeStepper.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace PartyKel{
+    AdaptiveTimeStepper::AdaptiveTimeStepper(float safetyFactor, float maxDisplacement, float growthFactor, float minTimeStep):
+        m_fSafetyFactor(safetyFactor), m_fMaxDisplacement(maxDisplacement),
+        m_fGrowthFactor(growthFactor), m_fMinTimeStep(minTimeStep),
+        m_fTimeStep(std::numeric_limits<float>::max()), m_nLastSubStepCount(0) {}
+
+    uint32_t AdaptiveTimeStepper::advance(Flag& flag, AbstractIntegrator<glm::vec3>& integrator, float frameDt, float brakeDt, const ForceEvaluator& computeForces) {
+        m_nLastSubStepCount = 0;
+        float remaining = frameDt;
+
+        while(remaining > 0.f) {
+            float stableDt = m_fSafetyFactor * flag.estimateStableTimeStep(integrator.getStabilityLimit(), brakeDt, m_fMaxDisplacement);
+
+            m_fTimeStep = std::min(stableDt, m_fTimeStep * m_fGrowthFactor);
+            m_fTimeStep = std::max(m_fTimeStep, m_fMinTimeStep);
+
+            // Répartit le temps restant en sous-pas égaux pour ne pas finir par un pas minuscule.
+            // Le dernier sous-pas consomme exactement remaining, ce qui termine la boucle
+            float subStepCount = std::ceil(remaining / m_fTimeStep);
+            float h = subStepCount > 1.f ? remaining / subStepCount : remaining;
+
+            flag.update(integrator, h, computeForces);
+            remaining -= h;
+            ++m_nLastSubStepCount;
+        }
+
+        return m_nLastSubStepCount;
+    }
+
+    void AdaptiveTimeStepper::reset() {
+        m_fTimeStep = std::numeric_limits<float>::max();
+    }
+
+    float AdaptiveTimeStepper::getTimeStep() const {
+        return m_fTimeStep;
+    }
+
+    uint32_t AdaptiveTimeStepper::getLastSubStepCount() const {
+        return m_nLastSubStepCount;
+    }
+
+    float& AdaptiveTimeStepper::safetyFactor() {
+        return m_fSafetyFactor;
+    }
+
+    float& AdaptiveTimeStepper::maxDisplacement() {
+        return m_fMaxDisplacement;
+    }
+
+    float& AdaptiveTimeStepper::growthFactor() {
+        return m_fGrowthFactor;
+    }
+}
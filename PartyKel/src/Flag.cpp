@@ -0,0 +1,348 @@
+#include "PartyKel/Flag.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace PartyKel{
+
+    // Calcule une force de type ressort de Hook entre deux particules de positions P1 et P2
+    // K est la résistance du ressort et L sa longueur à vide
+    inline glm::vec3 hookForce(float K, float L, const glm::vec3& P1, const glm::vec3& P2) {
+        static const float epsilon = 0.0001;
+        return K * (1-(L/std::max(glm::distance(P1, P2), epsilon))) * (P2 - P1);
+    }
+
+    inline glm::vec3 repulseForce(float dst, const glm::vec3& P1, const glm::vec3& P2) {
+    //    return 1.f - glm::normalize(P1 - P2) * dst ;
+        glm::vec3 direction = glm::normalize(P1 - P2);
+        return direction * (1 / (1 + glm::pow(dst, 2.f)));
+    }
+
+
+    // Calcule une force de type frein cinétique entre deux particules de vélocités v1 et v2
+    // V est le paramètre du frein et dt le pas temporel
+    inline glm::vec3 brakeForce(float V, float dt, const glm::vec3& v1, const glm::vec3& v2) {
+        return V * ((v2-v1) / dt);
+    }
+
+    inline glm::vec3 sphereCollisionForce(float distanceToCenter, const glm::vec3& sphereCenter, float sphereRadius, const glm::vec3 particlePosition, const glm::vec3& forceParticle) {
+
+        glm::vec3 direction = glm::normalize(particlePosition - sphereCenter);
+        return direction * (1 / (1 + glm::pow(distanceToCenter, 2.f)));
+    }
+
+    Flag::Flag(float mass, float width, float height, int gridWidth, int gridHeight):
+            gridWidth(gridWidth), gridHeight(gridHeight),
+            positionArray(gridWidth * gridHeight),
+            velocityArray(gridWidth * gridHeight, glm::vec3(0.f)),
+            massArray(gridWidth * gridHeight, mass / (gridWidth * gridHeight)),
+            forceArray(gridWidth * gridHeight, glm::vec3(0.f)),
+            awakeArray(gridWidth * gridHeight, 1),
+            triangleNormalArray(2 * (gridWidth - 1) * (gridHeight - 1), glm::vec3(0.f, 0.f, 1.f)),
+            patchArray(buildGridPatches(gridWidth, gridHeight)) {
+
+
+        glm::vec3 origin(-0.5f * width, -0.5f * height, 0.f);
+        glm::vec3 scale(width / (gridWidth - 1), height / (gridHeight - 1), 1.f);
+
+        nbParticles = gridWidth * gridHeight;
+        for(int j = 0; j < gridHeight; ++j) {
+            for(int i = 0; i < gridWidth; ++i) {
+                int k = i + j * gridWidth;
+                positionArray[k] = origin + glm::vec3(i, j, origin.z) * scale;
+                massArray[k] = 1 - ( i / (2*(gridHeight*gridWidth)));
+            }
+        }
+
+        // Les longueurs à vide sont calculés à partir de la position initiale
+        // des points sur le drapeau
+        L0.x = scale.x;
+        L0.y = scale.y;
+        L1 = glm::length(L0);
+        L2 = 2.f * L0;
+
+        // Ces paramètres sont à fixer pour avoir un système stable: HAVE FUN !
+        K0 = 1;
+        K1 = 1;
+        K2 = 1;
+
+        V0 = 0.08;
+        V1 = 0.02;
+        V2 = 0.06;
+
+        Cd = 1.5;
+        Cl = 0.5;
+
+        patchBounds.resize(patchArray.size());
+        updatePatchBounds();
+    }
+
+    void Flag::applyInternalForces(float dt) {
+        std::vector<glm::ivec2> neighbors(4);
+        for(int i = 0; i<gridWidth; ++i){
+            for(int j = 1; j<gridHeight; ++j){
+                int currentK = j*gridWidth + i;
+                if(!awakeArray[currentK])
+                    continue;
+//                if(currentK == nbParticles-1 || currentK == nbParticles - gridWidth)
+//                    continue;
+
+                // TOPOLOGY 1
+                neighbors[0] = glm::ivec2(i+1, j);
+                neighbors[1] = glm::ivec2(i-1, j);
+                neighbors[2] = glm::ivec2(i, j-1);
+                neighbors[3] = glm::ivec2(i, j+1);
+
+                int tmpI = 0;
+                for(auto& p : neighbors){
+                    if(p.x < 0 || p.y < 0 || p.x >= gridWidth || p.y >= gridHeight)
+                        continue;
+                    int k = p.y * gridWidth + p.x;
+                    forceArray[currentK] += hookForce(K0, tmpI < 2 ? L0.x : L0.y, positionArray[currentK], positionArray[k]);
+                    forceArray[currentK] += brakeForce(V0, dt, velocityArray[currentK], velocityArray[k]);
+                    ++tmpI;
+                }
+
+                // TOPOLOGY 2
+                neighbors[0] = glm::ivec2(i-1, j-1);
+                neighbors[1] = glm::ivec2(i+1, j-1);
+                neighbors[2] = glm::ivec2(i+1, j+1);
+                neighbors[3] = glm::ivec2(i-1, j+1);
+
+                for(auto& p : neighbors){
+                    if(p.x < 0 || p.y < 0 || p.x >= gridWidth || p.y >= gridHeight)
+                        continue;
+                    int k = p.y * gridWidth + p.x;
+                    forceArray[currentK] += hookForce(K1, L1, positionArray[currentK], positionArray[k]);
+                    forceArray[currentK] += brakeForce(V1, dt, velocityArray[currentK], velocityArray[k]);
+                }
+
+                // TOPOLOGY 3
+                neighbors[0] = glm::ivec2(i-2, j);
+                neighbors[1] = glm::ivec2(i+2, j);
+                neighbors[2] = glm::ivec2(i, j-2);
+                neighbors[3] = glm::ivec2(i, j+2);
+
+                tmpI = 0;
+                for(auto& p : neighbors){
+                    if(p.x < 0 || p.y < 0 || p.x >= gridWidth || p.y >= gridHeight)
+                        continue;
+                    int k = p.y * gridWidth + p.x;
+                    forceArray[currentK] += hookForce(K2, tmpI < 2 ? L2.x : L2.y, positionArray[currentK], positionArray[k]);
+                    forceArray[currentK] += brakeForce(V2, dt, velocityArray[currentK], velocityArray[k]);
+                    ++tmpI;
+                }
+
+            }
+        }
+    }
+
+    void Flag::applyRepulseForces(Octree<glm::vec3>& octree, float maxDst, float multRepulse){
+        for(int i = 0; i<gridWidth; ++i) {
+            for (int j = 1; j < gridHeight; ++j) {
+                int k = j*gridWidth + i;
+                if(!awakeArray[k])
+                    continue;
+                auto& pos = positionArray[k];
+
+                auto &inSameVoxel = octree.get(pos);
+                assert(!inSameVoxel.empty());
+
+                if (inSameVoxel.size() < 2)
+                    continue;
+
+                for (auto &v : inSameVoxel) {
+                    float dst = glm::distance(v, pos);
+                    if (dst > maxDst || pos == v)
+                        continue;
+
+                    forceArray[k] += repulseForce(dst, pos, v) * multRepulse;
+                }
+            }
+        }
+    }
+
+    void Flag::applyExternalForce(const glm::vec3& F) {
+
+        for(int i = 0; i < nbParticles; ++i){
+//            if( (i%gridWidth) == 0)
+//                continue;
+            if(i<gridWidth || !awakeArray[i])
+                continue;
+            forceArray[i] += F;
+        }
+
+    }
+
+    void Flag::applyWindField(const WindField& windField, float time, float scale) {
+        for(int i = gridWidth; i < nbParticles; ++i){
+            if(!awakeArray[i])
+                continue;
+            forceArray[i] += scale * windField.sample(positionArray[i], time);
+        }
+    }
+
+    void Flag::applyAerodynamicForces(const WindField& windField, float time, float windSpeed) {
+        // Un point reçoit des forces s'il est éveillé et n'est pas sur la ligne fixe
+        auto applyToVertex = [this](int k, const glm::vec3& F) {
+            if(k >= gridWidth && awakeArray[k])
+                forceArray[k] += F;
+        };
+
+        auto applyToTriangle = [&](int a, int b, int c, glm::vec3& triangleNormal) {
+            const glm::vec3& A = positionArray[a];
+            const glm::vec3& B = positionArray[b];
+            const glm::vec3& C = positionArray[c];
+
+            triangleNormal = glm::cross(B - A, C - A);
+            float doubleArea = glm::length(triangleNormal);
+            if(doubleArea < 0.0001f)
+                return;
+
+            glm::vec3 center = (A + B + C) / 3.f;
+            glm::vec3 triangleVelocity = (velocityArray[a] + velocityArray[b] + velocityArray[c]) / 3.f;
+            glm::vec3 relativeWind = windSpeed * windField.sample(center, time) - triangleVelocity;
+
+            float speed = glm::length(relativeWind);
+            if(speed < 0.0001f)
+                return;
+
+            glm::vec3 windDirection = relativeWind / speed;
+            glm::vec3 N = triangleNormal / doubleArea;
+            float cosTheta = glm::dot(N, windDirection);
+            if(cosTheta < 0.f) { // Face exposée au vent
+                N = -N;
+                cosTheta = -cosTheta;
+            }
+
+            float pressure = 0.5f * doubleArea * speed * speed * cosTheta;
+            glm::vec3 drag = Cd * pressure * windDirection;
+            glm::vec3 lift = Cl * pressure * (N - cosTheta * windDirection); // norme sin(theta)
+
+            glm::vec3 F = (drag + lift) / 3.f;
+            applyToVertex(a, F);
+            applyToVertex(b, F);
+            applyToVertex(c, F);
+        };
+
+        for(int j = 0; j < gridHeight - 1; ++j) {
+            for(int i = 0; i < gridWidth - 1; ++i) {
+                int k = i + j * gridWidth;
+                int t = 2 * (i + j * (gridWidth - 1));
+                applyToTriangle(k, k + 1, k + 1 + gridWidth, triangleNormalArray[t]);
+                applyToTriangle(k, k + 1 + gridWidth, k + gridWidth, triangleNormalArray[t + 1]);
+            }
+        }
+    }
+
+    void Flag::applySphereCollision(const SphereHandler& sphereHandler, float multiplier, float radiusDelta) {
+
+        for(int i = 0; i < nbParticles; ++i){
+            if( (i%gridWidth) == 0 || !awakeArray[i])
+                continue;
+
+            for(size_t j = 0; j < sphereHandler.positions.size(); ++j){
+                float dist = glm::distance(sphereHandler.positions[j], positionArray[i]);
+                if(dist < sphereHandler.radius[j] + radiusDelta){
+                    forceArray[i] += sphereCollisionForce(dist, sphereHandler.positions[j], sphereHandler.radius[j], positionArray[i], forceArray[i]) * multiplier;
+                }
+            }
+        }
+    }
+
+    void Flag::update(AbstractIntegrator<glm::vec3>& integrator, float dt, const ForceEvaluator& computeForces) {
+        integrator.step(getParticleArrays(), dt, computeForces);
+        updatePatchBounds();
+    }
+
+    void Flag::updatePatchBounds() {
+        for(size_t k = 0; k < patchArray.size(); ++k) {
+            const GridPatch& patch = patchArray[k];
+            glm::vec3 AABBmin(std::numeric_limits<float>::max()), AABBmax(-std::numeric_limits<float>::max());
+            for(int j = patch.quadBeginJ; j <= patch.quadEndJ; ++j) {
+                for(int i = patch.quadBeginI; i <= patch.quadEndI; ++i) {
+                    AABBmin = glm::min(AABBmin, positionArray[i + j * gridWidth]);
+                    AABBmax = glm::max(AABBmax, positionArray[i + j * gridWidth]);
+                }
+            }
+            patchBounds.set(k, AABBmin, AABBmax);
+        }
+    }
+
+    uint32_t Flag::computeVisiblePatches(const glm::mat4& MVP, std::vector<uint8_t>& visiblePatches) const {
+        std::vector<uint32_t> visibilityMask;
+        uint32_t visibleCount = Geometry::Frustum(MVP).cull(patchBounds, visibilityMask);
+
+        visiblePatches.resize(patchArray.size());
+        for(size_t k = 0; k < patchArray.size(); ++k)
+            visiblePatches[k] = Geometry::Frustum::isVisible(visibilityMask, k);
+        return visibleCount;
+    }
+
+    void Flag::getAABB(glm::vec3& AABBmin, glm::vec3& AABBmax) const {
+        AABBmin = glm::vec3(std::numeric_limits<float>::max());
+        AABBmax = glm::vec3(-std::numeric_limits<float>::max());
+        for(size_t k = 0; k < patchArray.size(); ++k) {
+            glm::vec3 patchMin, patchMax;
+            patchBounds.getBounds(k, patchMin, patchMax);
+            AABBmin = glm::min(AABBmin, patchMin);
+            AABBmax = glm::max(AABBmax, patchMax);
+        }
+    }
+
+    float Flag::estimateStableTimeStep(float stabilityLimit, float brakeDt, float maxDisplacement) const {
+        float minMass = *std::min_element(massArray.begin(), massArray.end());
+
+        // Chaque point est relié à 4 ressorts de chaque topologie
+        float stiffness = 2.f * 4.f * (std::abs(K0) + std::abs(K1) + std::abs(K2));
+        float damping = 2.f * 4.f * (std::abs(V0) + std::abs(V1) + std::abs(V2)) / brakeDt;
+
+        float stableDt = std::numeric_limits<float>::max();
+        if(stiffness > 0.f)
+            stableDt = stabilityLimit / std::sqrt(stiffness / minMass);
+        if(damping > 0.f)
+            stableDt = std::min(stableDt, 2.f * minMass / damping);
+
+        // Vitesse et accélération relatives maximales entre voisins directs: une translation
+        // d'ensemble ne déforme pas le drapeau, seule la variation de longueur des ressorts compte
+        float maxVelocity = 0.f, maxAcceleration = 0.f;
+        for(int j = 0; j < gridHeight; ++j) {
+            for(int i = 0; i < gridWidth; ++i) {
+                int k = i + j * gridWidth;
+                glm::vec3 acceleration = forceArray[k] / massArray[k];
+
+                if(i + 1 < gridWidth) {
+                    maxVelocity = std::max(maxVelocity, glm::length(velocityArray[k + 1] - velocityArray[k]));
+                    maxAcceleration = std::max(maxAcceleration, glm::length(forceArray[k + 1] / massArray[k + 1] - acceleration));
+                }
+                if(j + 1 < gridHeight) {
+                    maxVelocity = std::max(maxVelocity, glm::length(velocityArray[k + gridWidth] - velocityArray[k]));
+                    maxAcceleration = std::max(maxAcceleration, glm::length(forceArray[k + gridWidth] / massArray[k + gridWidth] - acceleration));
+                }
+            }
+        }
+
+        // Plus grand h tel que v * h + a * h^2 / 2 <= distance
+        float distance = maxDisplacement * std::min(L0.x, L0.y);
+        if(maxAcceleration > 0.f) {
+            float h = (std::sqrt(maxVelocity * maxVelocity + 2.f * maxAcceleration * distance) - maxVelocity) / maxAcceleration;
+            stableDt = std::min(stableDt, h);
+        } else if(maxVelocity > 0.f) {
+            stableDt = std::min(stableDt, distance / maxVelocity);
+        }
+
+        return stableDt;
+    }
+
+    ParticleArrays<glm::vec3> Flag::getParticleArrays() {
+        ParticleArrays<glm::vec3> particles;
+        particles.count = nbParticles;
+        particles.positions = positionArray.data();
+        particles.velocities = velocityArray.data();
+        particles.forces = forceArray.data();
+        particles.masses = massArray.data();
+        particles.awake = awakeArray.data();
+        return particles;
+    }
+}
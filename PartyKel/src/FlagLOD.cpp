@@ -0,0 +1,113 @@
+#include "PartyKel/FlagLOD.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace PartyKel{
+    FlagLOD::FlagLOD(float mass, float width, float height, int gridWidth, int gridHeight,
+                     int levelCount, float baseDistance, float hysteresis):
+        m_nLevel(0), m_fBaseDistance(baseDistance), m_fHysteresis(hysteresis) {
+
+        assert(levelCount >= 1);
+        float cellArea = width * height / ((gridWidth - 1) * (gridHeight - 1));
+        for(int level = 0; level < levelCount; ++level) {
+            int levelWidth = std::max(2, ((gridWidth - 1) >> level) + 1);
+            int levelHeight = std::max(2, ((gridHeight - 1) >> level) + 1);
+            m_levels.push_back(Flag(mass, width, height, levelWidth, levelHeight));
+
+            float levelCellArea = width * height / ((levelWidth - 1) * (levelHeight - 1));
+            m_pointScales.push_back(levelCellArea / cellArea);
+            for(auto& m : m_levels.back().massArray)
+                m *= m_pointScales.back();
+
+            if(level > 0)
+                m_upSamplers.push_back(GridSubdivider(levelWidth, levelHeight, gridWidth, gridHeight));
+        }
+    }
+
+    bool FlagLOD::update(const glm::vec3& cameraPosition) {
+        glm::vec3 AABBmin, AABBmax;
+        getFlag().getAABB(AABBmin, AABBmax);
+        float distance = glm::distance(cameraPosition, 0.5f * (AABBmin + AABBmax));
+
+        // Le seuil entre les niveaux l et l + 1 est baseDistance * 2^l
+        int level = m_nLevel;
+        while(level + 1 < getLevelCount() && distance > m_fBaseDistance * std::ldexp(1.f, level) * (1.f + m_fHysteresis))
+            ++level;
+        while(level > 0 && distance < m_fBaseDistance * std::ldexp(1.f, level - 1) * (1.f - m_fHysteresis))
+            --level;
+
+        if(level == m_nLevel)
+            return false;
+        transfer(level);
+        return true;
+    }
+
+    void FlagLOD::setLevel(int level) {
+        level = std::max(0, std::min(level, getLevelCount() - 1));
+        if(level != m_nLevel)
+            transfer(level);
+    }
+
+    void FlagLOD::transfer(int level) {
+        const Flag& from = m_levels[m_nLevel];
+        Flag& to = m_levels[level];
+
+        to.K0 = from.K0;
+        to.K1 = from.K1;
+        to.K2 = from.K2;
+        to.V0 = from.V0;
+        to.V1 = from.V1;
+        to.V2 = from.V2;
+        to.Cd = from.Cd;
+        to.Cl = from.Cl;
+
+        // Positions et vitesses interpolées sur la nouvelle grille (la ligne fixe j = 0 est conservée)
+        GridSubdivider resampler(from.gridWidth, from.gridHeight, to.gridWidth, to.gridHeight);
+        const glm::vec3* positions = resampler.subdivide(from.positionArray.data());
+        std::copy(positions, positions + to.nbParticles, to.positionArray.begin());
+        const glm::vec3* velocities = resampler.subdivide(from.velocityArray.data());
+        std::copy(velocities, velocities + to.nbParticles, to.velocityArray.begin());
+
+        std::fill(to.forceArray.begin(), to.forceArray.end(), glm::vec3(0.f));
+        std::fill(to.awakeArray.begin(), to.awakeArray.end(), 1);
+        to.updatePatchBounds();
+
+        m_nLevel = level;
+    }
+
+    Flag& FlagLOD::getFlag() {
+        return m_levels[m_nLevel];
+    }
+
+    const Flag& FlagLOD::getFlag() const {
+        return m_levels[m_nLevel];
+    }
+
+    const glm::vec3* FlagLOD::getFullResolutionPositions() {
+        if(m_nLevel == 0)
+            return m_levels[0].positionArray.data();
+        return m_upSamplers[m_nLevel - 1].subdivide(m_levels[m_nLevel].positionArray.data());
+    }
+
+    float FlagLOD::getPointScale() const {
+        return m_pointScales[m_nLevel];
+    }
+
+    int FlagLOD::getLevel() const {
+        return m_nLevel;
+    }
+
+    int FlagLOD::getLevelCount() const {
+        return m_levels.size();
+    }
+
+    float& FlagLOD::baseDistance() {
+        return m_fBaseDistance;
+    }
+
+    float& FlagLOD::hysteresis() {
+        return m_fHysteresis;
+    }
+}
@@ -0,0 +1,23 @@
+#include "PartyKel/GridPatch.hpp"
+
+#include <algorithm>
+
+namespace PartyKel{
+
+    std::vector<GridPatch> buildGridPatches(int gridWidth, int gridHeight, int patchQuads) {
+        std::vector<GridPatch> patches;
+        patches.reserve(gridPatchColumnCount(gridWidth, patchQuads) * gridPatchRowCount(gridHeight, patchQuads));
+
+        for(int i = 0; i < gridWidth - 1; i += patchQuads) {
+            for(int j = 0; j < gridHeight - 1; j += patchQuads) {
+                GridPatch patch;
+                patch.quadBeginI = i;
+                patch.quadBeginJ = j;
+                patch.quadEndI = std::min(i + patchQuads, gridWidth - 1);
+                patch.quadEndJ = std::min(j + patchQuads, gridHeight - 1);
+                patches.push_back(patch);
+            }
+        }
+        return patches;
+    }
+}
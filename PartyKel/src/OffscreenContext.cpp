@@ -0,0 +1,93 @@
+#include "PartyKel/OffscreenContext.hpp"
+
+#include <GL/glew.h>
+#include <stdexcept>
+#include <string>
+
+#ifdef PARTYKEL_USE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+namespace PartyKel {
+
+#ifdef PARTYKEL_USE_EGL
+
+OffscreenContext::OffscreenContext(): m_pDisplay(nullptr), m_pContext(nullptr) {
+    // Plateforme sans surface de Mesa: ni X11 ni Wayland nécessaires
+    EGLDisplay display = EGL_NO_DISPLAY;
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if(getPlatformDisplay) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+#endif
+    if(display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major, minor;
+    if(display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        throw std::runtime_error("Unable to initialize EGL");
+    }
+    m_pDisplay = display;
+
+    if(!eglBindAPI(EGL_OPENGL_API)) {
+        eglTerminate(display);
+        throw std::runtime_error("EGL: OpenGL API not supported");
+    }
+
+    // Pas de config ni de surface: le contexte est rendu courant sans surface (EGL_KHR_surfaceless_context)
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, (EGLConfig) nullptr, EGL_NO_CONTEXT, contextAttributes);
+    if(context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        if(context != EGL_NO_CONTEXT) {
+            eglDestroyContext(display, context);
+        }
+        eglTerminate(display);
+        throw std::runtime_error("Unable to create a surfaceless OpenGL 3.3 context");
+    }
+    m_pContext = context;
+
+    // Contexte core: GLEW doit charger les fonctions sans se fier à la liste des extensions
+    glewExperimental = GL_TRUE;
+    GLenum error = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // GLEW compilé pour GLX ne trouve pas de display X, mais les fonctions OpenGL sont chargées
+    if(error == GLEW_ERROR_NO_GLX_DISPLAY) {
+        error = GLEW_OK;
+    }
+#endif
+    glGetError(); // glewInit peut laisser GL_INVALID_ENUM (glGetString(GL_EXTENSIONS) en core)
+    if(error != GLEW_OK) {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+        throw std::runtime_error("Unable to init GLEW: " + std::string((const char*) glewGetErrorString(error)));
+    }
+}
+
+OffscreenContext::~OffscreenContext() {
+    EGLDisplay display = (EGLDisplay) m_pDisplay;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, (EGLContext) m_pContext);
+    eglTerminate(display);
+}
+
+#else
+
+OffscreenContext::OffscreenContext(): m_pDisplay(nullptr), m_pContext(nullptr) {
+    throw std::runtime_error("PartyKel was built without EGL: offscreen rendering is not available");
+}
+
+OffscreenContext::~OffscreenContext() {
+}
+
+#endif
+
+}
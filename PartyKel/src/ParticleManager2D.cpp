@@ -63,6 +63,19 @@ namespace PartyKel{
         return m_masses[i];
     }
 
+    glm::vec2* ParticleManager2D::getPositionArray(){
+        return m_positions.data();
+    }
+    glm::vec2* ParticleManager2D::getVelocityArray(){
+        return m_velocities.data();
+    }
+    glm::vec2* ParticleManager2D::getForceArray(){
+        return m_forces.data();
+    }
+    const float* ParticleManager2D::getMassArray() const{
+        return m_masses.data();
+    }
+
     void ParticleManager2D::addForce(const glm::vec2& f, int i){
         m_forces[i] += f;
     }
@@ -0,0 +1,29 @@
+#include "PartyKel/Solver2D.hpp"
+
+namespace PartyKel{
+    Solver2D::Solver2D(AbstractIntegrator<glm::vec2>& integrator): m_pIntegrator(&integrator){}
+
+    void Solver2D::setIntegrator(AbstractIntegrator<glm::vec2>& integrator) {
+        m_pIntegrator = &integrator;
+        m_pIntegrator->reset();
+    }
+
+    void Solver2D::addForce(AbstractForce& force) {
+        m_forces.push_back(&force);
+    }
+
+    void Solver2D::solve(ParticleManager2D &pm, float dt) {
+        ParticleArrays<glm::vec2> particles;
+        particles.count = pm.size();
+        particles.positions = pm.getPositionArray();
+        particles.velocities = pm.getVelocityArray();
+        particles.forces = pm.getForceArray();
+        particles.masses = pm.getMassArray();
+        particles.awake = nullptr;
+
+        m_pIntegrator->step(particles, dt, [&]() {
+            for(auto force : m_forces)
+                force->apply(pm);
+        });
+    }
+}
@@ -0,0 +1,91 @@
+#include "PartyKel/ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace PartyKel{
+    ThreadPool::ThreadPool(uint32_t threadCount):
+        m_nGeneration(0), m_nBusyWorkers(0), m_bStop(false),
+        m_pTask(nullptr), m_nCount(0), m_nChunkSize(1), m_nNextChunk(0) {
+
+        for(uint32_t i = 1; i < threadCount; ++i)
+            m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStop = true;
+        }
+        m_wakeCondition.notify_all();
+
+        for(auto& worker : m_workers)
+            worker.join();
+    }
+
+    void ThreadPool::runChunks() {
+        for(;;) {
+            uint32_t begin = m_nNextChunk.fetch_add(m_nChunkSize);
+            if(begin >= m_nCount)
+                break;
+            (*m_pTask)(begin, std::min(m_nCount, begin + m_nChunkSize));
+        }
+    }
+
+    void ThreadPool::workerLoop() {
+        uint64_t generation = 0;
+        for(;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wakeCondition.wait(lock, [&]() { return m_bStop || m_nGeneration != generation; });
+                if(m_bStop)
+                    return;
+                generation = m_nGeneration;
+            }
+
+            runChunks();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(--m_nBusyWorkers == 0)
+                m_doneCondition.notify_one();
+        }
+    }
+
+    void ThreadPool::parallelFor(uint32_t count, uint32_t grainSize, const Task& task) {
+        grainSize = std::max(grainSize, 1u);
+        if(m_workers.empty() || count <= grainSize) {
+            if(count > 0)
+                task(0, count);
+            return;
+        }
+
+        std::lock_guard<std::mutex> callLock(m_callMutex);
+
+        // Quelques blocs par thread pour équilibrer la charge
+        uint32_t chunkCount = 4 * getThreadCount();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pTask = &task;
+            m_nCount = count;
+            m_nChunkSize = std::max(grainSize, (count + chunkCount - 1) / chunkCount);
+            m_nNextChunk = 0;
+            m_nBusyWorkers = m_workers.size();
+            ++m_nGeneration;
+        }
+        m_wakeCondition.notify_all();
+
+        runChunks();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [&]() { return m_nBusyWorkers == 0; });
+        m_pTask = nullptr;
+    }
+
+    uint32_t ThreadPool::getThreadCount() const {
+        return m_workers.size() + 1;
+    }
+
+    ThreadPool& ThreadPool::getDefault() {
+        static ThreadPool pool;
+        return pool;
+    }
+}
@@ -0,0 +1,182 @@
+#include "PartyKel/TileSleepController.hpp"
+
+#include <algorithm>
+
+namespace PartyKel{
+    TileSleepController::TileSleepController(int tileSize, float energyThreshold, float forceThreshold,
+                                             float externalForceThreshold, uint32_t sleepFrames):
+        m_nTileSize(tileSize), m_nTileCountX(0), m_nTileCountY(0),
+        m_lastExternalForce(0.f),
+        m_fEnergyThreshold(energyThreshold), m_fForceThreshold(forceThreshold),
+        m_fExternalForceThreshold(externalForceThreshold), m_nSleepFrames(sleepFrames) {}
+
+    void TileSleepController::init(const Flag& flag) {
+        // Grille déjà découpée pour ce drapeau
+        if(!m_tiles.empty() && m_nTileCountX == (flag.gridWidth + m_nTileSize - 1) / m_nTileSize
+                            && m_nTileCountY == (flag.gridHeight + m_nTileSize - 1) / m_nTileSize)
+            return;
+
+        m_nTileCountX = (flag.gridWidth + m_nTileSize - 1) / m_nTileSize;
+        m_nTileCountY = (flag.gridHeight + m_nTileSize - 1) / m_nTileSize;
+
+        Tile tile;
+        tile.awake = true;
+        tile.calmFrames = 0;
+        tile.AABBmin = tile.AABBmax = glm::vec3(0.f);
+        m_tiles.assign(m_nTileCountX * m_nTileCountY, tile);
+    }
+
+    void TileSleepController::setTileAwake(Flag& flag, int tileX, int tileY, bool awake) {
+        Tile& tile = m_tiles[tileX + tileY * m_nTileCountX];
+        if(tile.awake == awake)
+            return;
+
+        tile.awake = awake;
+        tile.calmFrames = 0;
+
+        int iEnd = std::min(flag.gridWidth, (tileX + 1) * m_nTileSize);
+        int jEnd = std::min(flag.gridHeight, (tileY + 1) * m_nTileSize);
+
+        if(!awake)
+            tile.AABBmin = tile.AABBmax = flag.positionArray[tileX * m_nTileSize + tileY * m_nTileSize * flag.gridWidth];
+
+        for(int j = tileY * m_nTileSize; j < jEnd; ++j) {
+            for(int i = tileX * m_nTileSize; i < iEnd; ++i) {
+                int k = i + j * flag.gridWidth;
+                flag.awakeArray[k] = awake;
+                if(!awake) {
+                    // Un point endormi est immobile: il repartira de zéro à son réveil
+                    flag.velocityArray[k] = glm::vec3(0.f);
+                    flag.forceArray[k] = glm::vec3(0.f);
+                    tile.AABBmin = glm::min(tile.AABBmin, flag.positionArray[k]);
+                    tile.AABBmax = glm::max(tile.AABBmax, flag.positionArray[k]);
+                }
+            }
+        }
+    }
+
+    bool TileSleepController::hasMovingNeighbor(int tileX, int tileY) const {
+        for(int y = std::max(0, tileY - 1); y <= std::min(m_nTileCountY - 1, tileY + 1); ++y) {
+            for(int x = std::max(0, tileX - 1); x <= std::min(m_nTileCountX - 1, tileX + 1); ++x) {
+                if((x != tileX || y != tileY) && m_movingTiles[x + y * m_nTileCountX])
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    void TileSleepController::update(Flag& flag) {
+        init(flag);
+
+        // Mesure de l'agitation des tuiles éveillées
+        for(int tileY = 0; tileY < m_nTileCountY; ++tileY) {
+            for(int tileX = 0; tileX < m_nTileCountX; ++tileX) {
+                Tile& tile = m_tiles[tileX + tileY * m_nTileCountX];
+                if(!tile.awake)
+                    continue;
+
+                int iEnd = std::min(flag.gridWidth, (tileX + 1) * m_nTileSize);
+                int jEnd = std::min(flag.gridHeight, (tileY + 1) * m_nTileSize);
+
+                bool calm = true;
+                for(int j = tileY * m_nTileSize; j < jEnd && calm; ++j) {
+                    for(int i = tileX * m_nTileSize; i < iEnd; ++i) {
+                        int k = i + j * flag.gridWidth;
+                        float energy = 0.5f * flag.massArray[k] * glm::dot(flag.velocityArray[k], flag.velocityArray[k]);
+                        if(energy > m_fEnergyThreshold || glm::length(flag.forceArray[k]) > m_fForceThreshold) {
+                            calm = false;
+                            break;
+                        }
+                    }
+                }
+
+                tile.calmFrames = calm ? tile.calmFrames + 1 : 0;
+            }
+        }
+
+        // Tuiles en mouvement avant les réveils de cette frame: une tuile réveillée ici a calmFrames == 0
+        // mais ne doit pas réveiller ses voisines avant la frame suivante (un anneau de tuiles par update)
+        m_movingTiles.assign(m_tiles.size(), false);
+        for(size_t t = 0; t < m_tiles.size(); ++t)
+            m_movingTiles[t] = m_tiles[t].awake && m_tiles[t].calmFrames == 0;
+
+        // Une tuile dormante se réveille si une tuile voisine (8-connexité) est en mouvement
+        for(int tileY = 0; tileY < m_nTileCountY; ++tileY) {
+            for(int tileX = 0; tileX < m_nTileCountX; ++tileX) {
+                if(m_tiles[tileX + tileY * m_nTileCountX].awake)
+                    continue;
+
+                if(hasMovingNeighbor(tileX, tileY))
+                    setTileAwake(flag, tileX, tileY, true);
+            }
+        }
+
+        // Endort les tuiles calmes depuis assez longtemps
+        for(int tileY = 0; tileY < m_nTileCountY; ++tileY) {
+            for(int tileX = 0; tileX < m_nTileCountX; ++tileX) {
+                const Tile& tile = m_tiles[tileX + tileY * m_nTileCountX];
+                if(tile.awake && tile.calmFrames >= m_nSleepFrames)
+                    setTileAwake(flag, tileX, tileY, false);
+            }
+        }
+    }
+
+    void TileSleepController::wakeInSphere(Flag& flag, const glm::vec3& center, float radius) {
+        init(flag);
+        for(int tileY = 0; tileY < m_nTileCountY; ++tileY) {
+            for(int tileX = 0; tileX < m_nTileCountX; ++tileX) {
+                const Tile& tile = m_tiles[tileX + tileY * m_nTileCountX];
+                if(tile.awake)
+                    continue;
+
+                glm::vec3 closest = glm::clamp(center, tile.AABBmin, tile.AABBmax);
+                if(glm::distance(closest, center) <= radius)
+                    setTileAwake(flag, tileX, tileY, true);
+            }
+        }
+    }
+
+    void TileSleepController::notifyExternalForce(Flag& flag, const glm::vec3& F) {
+        if(glm::distance(F, m_lastExternalForce) > m_fExternalForceThreshold) {
+            wakeAll(flag);
+            m_lastExternalForce = F;
+        }
+    }
+
+    void TileSleepController::wakeAll(Flag& flag) {
+        init(flag);
+        for(int tileY = 0; tileY < m_nTileCountY; ++tileY) {
+            for(int tileX = 0; tileX < m_nTileCountX; ++tileX)
+                setTileAwake(flag, tileX, tileY, true);
+        }
+    }
+
+    void TileSleepController::reset() {
+        m_tiles.clear();
+        m_nTileCountX = m_nTileCountY = 0;
+    }
+
+    uint32_t TileSleepController::getSleepingTileCount() const {
+        return std::count_if(m_tiles.begin(), m_tiles.end(), [](const Tile& tile) { return !tile.awake; });
+    }
+
+    uint32_t TileSleepController::getTileCount() const {
+        return m_tiles.size();
+    }
+
+    float& TileSleepController::energyThreshold() {
+        return m_fEnergyThreshold;
+    }
+
+    float& TileSleepController::forceThreshold() {
+        return m_fForceThreshold;
+    }
+
+    float& TileSleepController::externalForceThreshold() {
+        return m_fExternalForceThreshold;
+    }
+
+    uint32_t& TileSleepController::sleepFrames() {
+        return m_nSleepFrames;
+    }
+}
@@ -0,0 +1,102 @@
+#include "PartyKel/WindField.hpp"
+
+#include <random>
+
+namespace PartyKel{
+
+    // Moyenne de chaque valeur avec ses voisines directes sur la grille périodique, selon un axe
+    static void blurAxis(std::vector<glm::vec3>& field, int resolution, int axis) {
+        std::vector<glm::vec3> source(field);
+        int mask = resolution - 1;
+        int stride = axis == 0 ? 1 : (axis == 1 ? resolution : resolution * resolution);
+
+        for(int k = 0; k < resolution; ++k) {
+            for(int j = 0; j < resolution; ++j) {
+                for(int i = 0; i < resolution; ++i) {
+                    int c[3] = {i, j, k};
+                    int index = i + resolution * (j + resolution * k);
+                    int previous = index + (((c[axis] - 1) & mask) - c[axis]) * stride;
+                    int next = index + (((c[axis] + 1) & mask) - c[axis]) * stride;
+                    field[index] = 0.25f * source[previous] + 0.5f * source[index] + 0.25f * source[next];
+                }
+            }
+        }
+    }
+
+    WindField::WindField(const glm::vec3& meanFlow, float turbulence, float cellSize, int resolution, uint32_t seed):
+        m_nResolution(1), m_fInvCellSize(1.f / cellSize),
+        m_meanFlow(meanFlow), m_fTurbulence(turbulence), m_scrollVelocity(glm::normalize(glm::vec3(1.f, 0.2f, 0.5f))) {
+
+        while(m_nResolution < resolution)
+            m_nResolution *= 2;
+        m_nMask = m_nResolution - 1;
+        m_nPlaneMask = m_nResolution * m_nResolution - 1;
+        m_nVolumeMask = m_nResolution * m_nResolution * m_nResolution - 1;
+
+        int cellCount = m_nResolution * m_nResolution * m_nResolution;
+
+        // Potentiel vecteur aléatoire, lissé pour que le champ varie sur plusieurs cellules
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+        std::vector<glm::vec3> potential(cellCount);
+        for(auto& psi : potential)
+            psi = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+
+        for(int pass = 0; pass < 2; ++pass) {
+            for(int axis = 0; axis < 3; ++axis)
+                blurAxis(potential, m_nResolution, axis);
+        }
+
+        // Turbulence = rotationnel du potentiel (différences centrées), donc sans divergence
+        auto psi = [&](int i, int j, int k) -> const glm::vec3& {
+            return potential[(i & m_nMask) + m_nResolution * ((j & m_nMask) + m_nResolution * (k & m_nMask))];
+        };
+
+        m_turbulence.resize(cellCount);
+        double sumSquares = 0.;
+        for(int k = 0; k < m_nResolution; ++k) {
+            for(int j = 0; j < m_nResolution; ++j) {
+                for(int i = 0; i < m_nResolution; ++i) {
+                    glm::vec3 dx = 0.5f * (psi(i + 1, j, k) - psi(i - 1, j, k));
+                    glm::vec3 dy = 0.5f * (psi(i, j + 1, k) - psi(i, j - 1, k));
+                    glm::vec3 dz = 0.5f * (psi(i, j, k + 1) - psi(i, j, k - 1));
+
+                    glm::vec3 curl(dy.z - dz.y, dz.x - dx.z, dx.y - dy.x);
+                    m_turbulence[i + m_nResolution * (j + m_nResolution * k)] = curl;
+                    sumSquares += glm::dot(curl, curl);
+                }
+            }
+        }
+
+        float rms = float(std::sqrt(sumSquares / cellCount));
+        if(rms > 0.f) {
+            for(auto& v : m_turbulence)
+                v /= rms;
+        }
+    }
+
+    void WindField::sample(const glm::vec3* positions, uint32_t count, float time, glm::vec3* forces) const {
+        for(uint32_t i = 0; i < count; ++i)
+            forces[i] = sample(positions[i], time);
+    }
+
+    int WindField::getResolution() const {
+        return m_nResolution;
+    }
+
+    float WindField::getCellSize() const {
+        return 1.f / m_fInvCellSize;
+    }
+
+    glm::vec3& WindField::meanFlow() {
+        return m_meanFlow;
+    }
+
+    float& WindField::turbulence() {
+        return m_fTurbulence;
+    }
+
+    glm::vec3& WindField::scrollVelocity() {
+        return m_scrollVelocity;
+    }
+}
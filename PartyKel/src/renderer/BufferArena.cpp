@@ -0,0 +1,115 @@
+#include "PartyKel/renderer/BufferArena.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+namespace PartyKel {
+
+// Comme pour le StreamBuffer, le buffer est manipulé via les cibles de copie qui ne modifient pas l'état du VAO courant
+
+BufferArena::BufferArena(GLsizeiptr capacity, GLenum usage):
+    m_BufferID(0), m_Usage(usage), m_nCapacity(std::max(capacity, GLsizeiptr(1))), m_nUsedSize(0), m_nGeneration(0) {
+    glGenBuffers(1, &m_BufferID);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_BufferID);
+    glBufferData(GL_COPY_WRITE_BUFFER, m_nCapacity, nullptr, m_Usage);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    m_FreeRanges[0] = m_nCapacity;
+}
+
+BufferArena::~BufferArena() {
+    glDeleteBuffers(1, &m_BufferID);
+}
+
+BufferArena::Allocation BufferArena::allocate(GLsizeiptr size, GLsizeiptr alignment) {
+    if(size <= 0)
+        return Allocation();
+    alignment = std::max(alignment, GLsizeiptr(1)); // 0: pas de contrainte d'alignement
+
+    for(;;) {
+        for(auto it = m_FreeRanges.begin(); it != m_FreeRanges.end(); ++it) {
+            GLintptr begin = it->first, end = it->first + it->second;
+            GLintptr offset = (begin + alignment - 1) / alignment * alignment;
+            if(offset + size > end)
+                continue;
+
+            // La zone libre est découpée: ce qui reste avant (alignement) et après la réservation reste libre
+            m_FreeRanges.erase(it);
+            if(offset > begin)
+                m_FreeRanges[begin] = offset - begin;
+            if(offset + size < end)
+                m_FreeRanges[offset + size] = end - (offset + size);
+
+            m_nUsedSize += size;
+            return Allocation(offset, size);
+        }
+
+        // Pire cas: la réservation commence alignment - 1 octets après le début de la dernière zone libre
+        grow(m_nCapacity + size + alignment);
+    }
+}
+
+void BufferArena::free(const Allocation& allocation) {
+    if(!allocation.isValid())
+        return;
+
+    m_nUsedSize -= allocation.size;
+    addFreeRange(allocation.offset, allocation.size);
+}
+
+void BufferArena::addFreeRange(GLintptr offset, GLsizeiptr size) {
+    auto next = m_FreeRanges.lower_bound(offset);
+
+    // Fusion avec la zone libre suivante
+    if(next != m_FreeRanges.end() && next->first == offset + size) {
+        size += next->second;
+        next = m_FreeRanges.erase(next);
+    }
+
+    // Fusion avec la zone libre précédente
+    if(next != m_FreeRanges.begin()) {
+        auto previous = std::prev(next);
+        if(previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+
+    m_FreeRanges[offset] = size;
+}
+
+void BufferArena::upload(const Allocation& allocation, const void* data, GLsizeiptr size, GLintptr offset) {
+    if(offset + size > allocation.size) {
+        std::cerr << "BufferArena::upload: " << size << " bytes at " << offset << " overflow an allocation of " << allocation.size << " bytes" << std::endl;
+        return;
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_BufferID);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.offset + offset, size, data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void BufferArena::grow(GLsizeiptr minCapacity) {
+    GLsizeiptr capacity = std::max(minCapacity, 2 * m_nCapacity);
+
+    GLuint bufferID;
+    glGenBuffers(1, &bufferID);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, m_Usage);
+
+    // Copie sur le GPU du contenu existant, les offsets des réservations restent donc valides
+    glBindBuffer(GL_COPY_READ_BUFFER, m_BufferID);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, m_nCapacity);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glDeleteBuffers(1, &m_BufferID);
+    m_BufferID = bufferID;
+
+    addFreeRange(m_nCapacity, capacity - m_nCapacity);
+    m_nCapacity = capacity;
+    ++m_nGeneration;
+}
+
+}
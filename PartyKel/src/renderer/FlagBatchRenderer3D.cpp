@@ -0,0 +1,376 @@
+#include "PartyKel/renderer/FlagBatchRenderer3D.hpp"
+#include "PartyKel/renderer/GLtools.hpp"
+#include "PartyKel/renderer/GridIndexBuffer.hpp"
+#include "graphics/CameraUniformBuffer.h"
+#include "PartyKel/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace PartyKel {
+
+const GLchar* FlagBatchRenderer3D::VERTEX_SHADER =
+"#version 330 core\n"
+CAMERA_UNIFORM_BLOCK_GLSL
+GL_STRINGIFY(
+    layout(location = 0) in vec3 aVertexPosition;
+    layout(location = 1) in vec3 aVertexNormal;
+
+
+    out vec3 vFragPosition;
+    out vec3 vFragNormal;
+
+    void main() {
+        vFragPosition = vec3(MVP * vec4(aVertexPosition, 1));
+        vFragNormal = vec3(MV * vec4(aVertexNormal, 0));
+        gl_Position = MVP * vec4(aVertexPosition, 1);
+    }
+);
+
+const GLchar* FlagBatchRenderer3D::FRAGMENT_SHADER =
+"#version 330 core\n"
+GL_STRINGIFY(
+    in vec3 vFragPosition;
+    in vec3 vFragNormal;
+
+    out vec3 fFragColor;
+
+    void main() {
+        fFragColor = vec3(abs(dot(normalize(vFragPosition), normalize(vFragNormal))));
+    }
+);
+
+// Variante lisant un PackedFlagVertex, la boîte englobante du drapeau est un attribut d'instance
+const GLchar* FlagBatchRenderer3D::PACKED_VERTEX_SHADER =
+"#version 330 core\n"
+CAMERA_UNIFORM_BLOCK_GLSL
+PACKED_VERTEX_GLSL
+GL_STRINGIFY(
+    layout(location = 0) in vec3 aVertexPosition;
+    layout(location = 1) in vec2 aVertexNormal;
+    layout(location = 2) in vec3 aBoxMin;
+    layout(location = 3) in vec3 aBoxSize;
+
+
+    out vec3 vFragPosition;
+    out vec3 vFragNormal;
+
+    void main() {
+        vec3 position = unpackPosition(aVertexPosition, aBoxMin, aBoxSize);
+        vFragPosition = vec3(MVP * vec4(position, 1));
+        vFragNormal = vec3(MV * vec4(unpackNormal(aVertexNormal), 0));
+        gl_Position = MVP * vec4(position, 1);
+    }
+);
+
+// Taille initiale de l'arène d'indices: une grille 100 x 20 (celle de la démo flag)
+static const GLsizeiptr INITIAL_INDEX_ARENA_SIZE = 6 * 99 * 19 * sizeof(GLushort);
+
+// Nombre de sommets traités par tâche du ThreadPool (plusieurs petits drapeaux par tâche)
+static const uint32_t VERTICES_PER_TASK = 4096;
+
+FlagBatchRenderer3D::FlagBatchRenderer3D(bool allowMultiDrawIndirect):
+    m_ProgramID(buildProgram(VERTEX_SHADER, FRAGMENT_SHADER)),
+    m_PackedProgramID(buildProgram(PACKED_VERTEX_SHADER, FRAGMENT_SHADER)),
+    m_CommandBufferID(0),
+    m_bMultiDrawIndirect(allowMultiDrawIndirect && (GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance))),
+    m_IndexArena(INITIAL_INDEX_ARENA_SIZE),
+    m_nIndexArenaGeneration(m_IndexArena.getGeneration()),
+    m_nVertexCount(0), m_bCommandsDirty(false), m_nShortCommandCount(0),
+    m_VertexFormat(FLOAT_VERTICES),
+    m_VertexStream(VERTICES_PER_TASK * sizeof(Vertex)) {
+
+    if(m_bMultiDrawIndirect) {
+        glGenBuffers(1, &m_CommandBufferID);
+    }
+
+    // Création du VAO
+    glGenVertexArrays(1, &m_VAOID);
+    glBindVertexArray(m_VAOID);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexArena.getBufferID());
+
+    // Les pointeurs des attributs sont donnés à chaque draw, selon la zone du StreamBuffer utilisée
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+
+    // Boîtes englobantes du format compressé: une par drapeau
+    glVertexAttribDivisor(2, 1);
+    glVertexAttribDivisor(3, 1);
+
+    glBindVertexArray(0);
+
+    // Matrices lues dans le bloc Camera (Graphics::CameraUniformBuffer)
+    Graphics::CameraUniformBuffer::bindProgram(m_ProgramID);
+    Graphics::CameraUniformBuffer::bindProgram(m_PackedProgramID);
+}
+
+FlagBatchRenderer3D::~FlagBatchRenderer3D() {
+    if(m_CommandBufferID) {
+        glDeleteBuffers(1, &m_CommandBufferID);
+    }
+    glDeleteVertexArrays(1, &m_VAOID);
+    glDeleteProgram(m_ProgramID);
+    glDeleteProgram(m_PackedProgramID);
+}
+
+const FlagBatchRenderer3D::GridPattern& FlagBatchRenderer3D::getGridPattern(int gridWidth, int gridHeight) {
+    auto it = m_GridPatterns.find(std::make_pair(gridWidth, gridHeight));
+    if(it != m_GridPatterns.end()) {
+        return it->second;
+    }
+
+    GridIndexBuffer indexBuffer(gridWidth, gridHeight);
+
+    GridPattern pattern;
+    pattern.indexCount = indexBuffer.count;
+    pattern.indexType = indexBuffer.type;
+    pattern.indices = m_IndexArena.allocate(indexBuffer.byteSize(), indexBuffer.indexSize());
+    m_IndexArena.upload(pattern.indices, indexBuffer.data(), indexBuffer.byteSize());
+
+    return m_GridPatterns[std::make_pair(gridWidth, gridHeight)] = pattern;
+}
+
+uint32_t FlagBatchRenderer3D::addFlag(int gridWidth, int gridHeight) {
+    FlagEntry flag;
+    flag.gridWidth = gridWidth;
+    flag.gridHeight = gridHeight;
+    flag.pPattern = &getGridPattern(gridWidth, gridHeight);
+    flag.baseVertex = m_nVertexCount;
+
+    m_Flags.push_back(flag);
+    m_nVertexCount += gridWidth * gridHeight;
+    m_bCommandsDirty = true;
+
+    return m_Flags.size() - 1;
+}
+
+void FlagBatchRenderer3D::removeFlags() {
+    m_Flags.clear();
+    m_nVertexCount = 0;
+    m_bCommandsDirty = true;
+}
+
+void FlagBatchRenderer3D::clear() {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void FlagBatchRenderer3D::uploadCommands(const std::vector<uint8_t>& visibleFlags) {
+    // Les baseVertex sont relatifs aux pointeurs des attributs (début des sommets de la frame):
+    // les commandes ne dépendent que de la liste des drapeaux et de leur visibilité (un drapeau invisible garde sa commande, avec 0 instance).
+    // Celles des grilles à indices 16 bits d'abord, celles à indices 32 bits ensuite (un glMultiDrawElementsIndirect par type)
+    std::vector<DrawElementsIndirectCommand>& commands = m_Commands;
+    commands.clear();
+    commands.reserve(m_Flags.size());
+    for(GLenum type : {GL_UNSIGNED_SHORT, GL_UNSIGNED_INT}) {
+        for(size_t i = 0; i < m_Flags.size(); ++i) {
+            const FlagEntry& flag = m_Flags[i];
+            if(flag.pPattern->indexType != type) {
+                continue;
+            }
+
+            DrawElementsIndirectCommand command;
+            command.count = flag.pPattern->indexCount;
+            command.instanceCount = visibleFlags.empty() ? 1 : visibleFlags[i];
+            command.firstIndex = flag.pPattern->indices.firstElement(type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint));
+            command.baseVertex = flag.baseVertex;
+            command.baseInstance = i; // Boîte du drapeau en format compressé
+            commands.push_back(command);
+        }
+
+        if(type == GL_UNSIGNED_SHORT) {
+            m_nShortCommandCount = commands.size();
+        }
+    }
+
+    // glBufferData réalloue le stockage: pas d'attente sur les draws indirects encore en cours qui lisent l'ancien
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_CommandBufferID);
+    glBufferData(GL_COPY_WRITE_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    m_CommandVisibility = visibleFlags;
+}
+
+namespace {
+
+// Normale d'un sommet: somme des produits vectoriels des 6 triangles adjacents, comme FlagRenderer3D
+// (triangle 0 = A B C, triangle 1 = A C D pour la case de coin A = (i, j))
+glm::vec3 vertexNormal(const glm::vec3* positionArray, int gridWidth, int gridHeight, int i, int j) {
+    auto P = [&](int i, int j) -> const glm::vec3& {
+        return positionArray[i + j * gridWidth];
+    };
+
+    bool hasLeft = i > 0, hasRight = i < gridWidth - 1;
+    bool hasBottom = j > 0, hasTop = j < gridHeight - 1;
+    const glm::vec3& A = P(i, j);
+
+    glm::vec3 N(0.f);
+    if(hasRight && hasTop) {
+        N += glm::cross(P(i + 1, j) - A, P(i + 1, j + 1) - A) + glm::cross(P(i + 1, j + 1) - A, P(i, j + 1) - A);
+    }
+    if(hasLeft && hasTop) {
+        const glm::vec3& L = P(i - 1, j);
+        N += glm::cross(A - L, P(i, j + 1) - L);
+    }
+    if(hasLeft && hasBottom) {
+        const glm::vec3& LB = P(i - 1, j - 1);
+        N += glm::cross(P(i, j - 1) - LB, A - LB) + glm::cross(A - LB, P(i - 1, j) - LB);
+    }
+    if(hasRight && hasBottom) {
+        const glm::vec3& B = P(i, j - 1);
+        N += glm::cross(P(i + 1, j) - B, A - B);
+    }
+
+    // Une normale nulle (triangles dégénérés) reste nulle
+    return N / std::sqrt(std::max(glm::dot(N, N), 1e-20f));
+}
+
+}
+
+void FlagBatchRenderer3D::writeVertices(const glm::vec3* positionArray, int gridWidth, int gridHeight, Vertex* pVertices) {
+    for(int j = 0; j < gridHeight; ++j) {
+        for(int i = 0; i < gridWidth; ++i) {
+            Vertex& vertex = pVertices[i + j * gridWidth];
+            vertex.position = positionArray[i + j * gridWidth];
+            vertex.normal = vertexNormal(positionArray, gridWidth, gridHeight, i, j);
+        }
+    }
+}
+
+void FlagBatchRenderer3D::writePackedVertices(const glm::vec3* positionArray, int gridWidth, int gridHeight,
+                                              PackedFlagVertex* pVertices, PackedFlagBox& box) {
+    glm::vec3 boxMin(std::numeric_limits<float>::max()), boxMax(-std::numeric_limits<float>::max());
+    for(int k = 0; k < gridWidth * gridHeight; ++k) {
+        boxMin = glm::min(boxMin, positionArray[k]);
+        boxMax = glm::max(boxMax, positionArray[k]);
+    }
+    box = PackedFlagBox(boxMin, boxMax);
+
+    for(int j = 0; j < gridHeight; ++j) {
+        for(int i = 0; i < gridWidth; ++i) {
+            PackedFlagVertex& vertex = pVertices[i + j * gridWidth];
+            box.packPosition(positionArray[i + j * gridWidth], vertex.position);
+            packNormal(vertexNormal(positionArray, gridWidth, gridHeight, i, j), vertex.normal);
+        }
+    }
+}
+
+void FlagBatchRenderer3D::drawFlags(const std::vector<const glm::vec3*>& positionArrays, bool wireframe,
+                                    const std::vector<uint8_t>& visibleFlags) {
+    assert(visibleFlags.empty() || visibleFlags.size() == m_Flags.size());
+    auto isVisible = [&](uint32_t i) {
+        return visibleFlags.empty() || visibleFlags[i];
+    };
+
+    bool noneVisible = !visibleFlags.empty() && std::find(visibleFlags.begin(), visibleFlags.end(), 1) == visibleFlags.end();
+    if(m_Flags.empty() || noneVisible) {
+        return;
+    }
+
+    glEnable(GL_DEPTH_TEST);
+
+    // Sommets de tous les drapeaux à la suite, un drapeau par tâche (ou plusieurs pour les petites grilles).
+    // Les sommets des drapeaux invisibles ne sont pas écrits (leur zone est gardée pour que les baseVertex restent fixes).
+    // Format compressé: les boîtes englobantes des drapeaux (une par instance) sont placées avant les sommets
+    bool packed = m_VertexFormat == PACKED_VERTICES;
+    GLsizeiptr boxesSize = packed ? m_Flags.size() * sizeof(PackedFlagBox) : 0;
+    GLsizeiptr verticesSize = m_nVertexCount * (packed ? sizeof(PackedFlagVertex) : sizeof(Vertex));
+    char* pData = static_cast<char*>(m_VertexStream.map(boxesSize + verticesSize));
+
+    m_FlagBoxes.resize(m_Flags.size());
+    uint32_t flagsPerTask = std::max<uint32_t>(1, VERTICES_PER_TASK * m_Flags.size() / m_nVertexCount);
+    ThreadPool::getDefault().parallelFor(m_Flags.size(), flagsPerTask, [&](uint32_t begin, uint32_t end) {
+        for(uint32_t i = begin; i < end; ++i) {
+            const FlagEntry& flag = m_Flags[i];
+            if(!isVisible(i)) {
+                continue;
+            }
+            if(packed) {
+                writePackedVertices(positionArrays[i], flag.gridWidth, flag.gridHeight,
+                                    reinterpret_cast<PackedFlagVertex*>(pData + boxesSize) + flag.baseVertex, m_FlagBoxes[i]);
+            } else {
+                writeVertices(positionArrays[i], flag.gridWidth, flag.gridHeight, reinterpret_cast<Vertex*>(pData) + flag.baseVertex);
+            }
+        }
+    });
+    std::memcpy(pData, m_FlagBoxes.data(), boxesSize);
+    GLintptr offset = m_VertexStream.unmap();
+
+    glUseProgram(packed ? m_PackedProgramID : m_ProgramID);
+
+    if(wireframe) {
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    } else {
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    }
+
+    glBindVertexArray(m_VAOID);
+        // L'arène a été agrandie par un addFlag: nouveau buffer d'indices
+        if(m_nIndexArenaGeneration != m_IndexArena.getGeneration()) {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexArena.getBufferID());
+            m_nIndexArenaGeneration = m_IndexArena.getGeneration();
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_VertexStream.getBufferID());
+        if(packed) {
+            PackedFlagVertex::setAttribPointers(0, 1, offset + boxesSize);
+        } else {
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*) (offset + offsetof(Vertex, position)));
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*) (offset + offsetof(Vertex, normal)));
+        }
+
+        // Boîte du drapeau: attribut d'instance (baseInstance = indice du drapeau) pour les draws indirects,
+        // attribut constant changé entre les draws sinon
+        bool instancedBoxes = packed && m_bMultiDrawIndirect;
+        if(instancedBoxes) {
+            glEnableVertexAttribArray(2);
+            glEnableVertexAttribArray(3);
+            glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(PackedFlagBox), (const GLvoid*) (offset + offsetof(PackedFlagBox, min)));
+            glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(PackedFlagBox), (const GLvoid*) (offset + offsetof(PackedFlagBox, size)));
+        } else {
+            glDisableVertexAttribArray(2);
+            glDisableVertexAttribArray(3);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        if(m_bMultiDrawIndirect) {
+            // Commandes réécrites seulement quand la liste des drapeaux ou l'ensemble des drapeaux visibles change
+            // (tous visibles: liste vide, pour ne pas réécrire en passant d'une liste vide à une liste pleine)
+            bool allVisible = visibleFlags.empty() || std::find(visibleFlags.begin(), visibleFlags.end(), 0) == visibleFlags.end();
+            if(m_bCommandsDirty || (allVisible ? !m_CommandVisibility.empty() : m_CommandVisibility != visibleFlags)) {
+                uploadCommands(allVisible ? std::vector<uint8_t>() : visibleFlags);
+                m_bCommandsDirty = false;
+            }
+
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBufferID);
+            GLsizei intCommandCount = m_Flags.size() - m_nShortCommandCount;
+            if(m_nShortCommandCount) {
+                glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, 0, m_nShortCommandCount, 0);
+            }
+            if(intCommandCount) {
+                glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                            (const GLvoid*) (m_nShortCommandCount * sizeof(DrawElementsIndirectCommand)), intCommandCount, 0);
+            }
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        } else {
+            for(size_t i = 0; i < m_Flags.size(); ++i) {
+                const FlagEntry& flag = m_Flags[i];
+                if(!isVisible(i)) {
+                    continue;
+                }
+                if(packed) {
+                    glVertexAttrib3fv(2, glm::value_ptr(m_FlagBoxes[i].min));
+                    glVertexAttrib3fv(3, glm::value_ptr(m_FlagBoxes[i].size));
+                }
+                glDrawElementsBaseVertex(GL_TRIANGLES, flag.pPattern->indexCount, flag.pPattern->indexType,
+                                         (const GLvoid*) flag.pPattern->indices.offset, flag.baseVertex);
+            }
+        }
+    glBindVertexArray(0);
+
+    m_VertexStream.fence();
+}
+
+}
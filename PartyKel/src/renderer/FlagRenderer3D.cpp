@@ -1,27 +1,34 @@
 #include "PartyKel/renderer/FlagRenderer3D.hpp"
 #include "PartyKel/renderer/GLtools.hpp"
+#include "PartyKel/renderer/GridIndexBuffer.hpp"
+#include "graphics/CameraUniformBuffer.h"
 #include "PartyKel/glm.hpp"
+#include "PartyKel/ThreadPool.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
 
 namespace PartyKel {
 
 const GLchar* FlagRenderer3D::VERTEX_SHADER =
 "#version 330 core\n"
+CAMERA_UNIFORM_BLOCK_GLSL
 GL_STRINGIFY(
     layout(location = 0) in vec3 aVertexPosition;
     layout(location = 1) in vec3 aVertexNormal;
 
-    uniform mat4 uMVPMatrix;
-    uniform mat4 uMVMatrix;
 
     out vec3 vFragPosition;
     out vec3 vFragNormal;
 
     void main() {
-        vFragPosition = vec3(uMVPMatrix * vec4(aVertexPosition, 1));
-        vFragNormal = vec3(uMVMatrix * vec4(aVertexNormal, 0));
-        gl_Position = uMVPMatrix * vec4(aVertexPosition, 1);
+        vFragPosition = vec3(MVP * vec4(aVertexPosition, 1));
+        vFragNormal = vec3(MV * vec4(aVertexNormal, 0));
+        gl_Position = MVP * vec4(aVertexPosition, 1);
     }
 );
 
@@ -38,180 +45,494 @@ GL_STRINGIFY(
     }
 );
 
+// Variante sans attributs de sommet: la position du point gl_VertexID et celles de ses 8 voisins sont lues
+// dans un buffer texture (x, y, z de chaque point à la suite), la normale est calculée comme sur le CPU:
+// somme des produits vectoriels des 6 triangles adjacents, les cases hors de la grille comptant pour zéro
+const GLchar* FlagRenderer3D::GPU_NORMALS_VERTEX_SHADER =
+"#version 330 core\n"
+CAMERA_UNIFORM_BLOCK_GLSL
+GL_STRINGIFY(
+    uniform samplerBuffer uPositions;
+    uniform int uFirstPosition; // Début des positions de la frame dans le buffer, en flottants
+    uniform int uGridWidth;
+    uniform int uGridHeight;
+
+
+    out vec3 vFragPosition;
+    out vec3 vFragNormal;
+
+    vec3 position(int i, int j) {
+        int k = uFirstPosition + 3 * (clamp(i, 0, uGridWidth - 1) + clamp(j, 0, uGridHeight - 1) * uGridWidth);
+        return vec3(texelFetch(uPositions, k).r, texelFetch(uPositions, k + 1).r, texelFetch(uPositions, k + 2).r);
+    }
+
+    void main() {
+        int i = gl_VertexID % uGridWidth;
+        int j = gl_VertexID / uGridWidth;
+
+        vec3 P00 = position(i - 1, j - 1);
+        vec3 P10 = position(i, j - 1);
+        vec3 P20 = position(i + 1, j - 1);
+        vec3 P01 = position(i - 1, j);
+        vec3 P11 = position(i, j);
+        vec3 P21 = position(i + 1, j);
+        vec3 P02 = position(i - 1, j + 1);
+        vec3 P12 = position(i, j + 1);
+        vec3 P22 = position(i + 1, j + 1);
+
+        float hasLeft = float(i > 0);
+        float hasRight = float(i < uGridWidth - 1);
+        float hasBottom = float(j > 0);
+        float hasTop = float(j < uGridHeight - 1);
+
+        // Case (i, j): triangles 0 et 1, case (i-1, j): triangle 0, case (i-1, j-1): triangles 0 et 1, case (i, j-1): triangle 1
+        vec3 N = hasRight * hasTop * (cross(P21 - P11, P22 - P11) + cross(P22 - P11, P12 - P11))
+               + hasLeft * hasTop * cross(P11 - P01, P12 - P01)
+               + hasLeft * hasBottom * (cross(P10 - P00, P11 - P00) + cross(P11 - P00, P01 - P00))
+               + hasRight * hasBottom * cross(P21 - P10, P11 - P10);
+
+        vFragPosition = vec3(MVP * vec4(P11, 1));
+        vFragNormal = vec3(MV * vec4(N / max(length(N), 1e-10), 0));
+        gl_Position = MVP * vec4(P11, 1);
+    }
+);
+
+// Variante lisant un PackedFlagVertex: position relative à la boîte englobante du drapeau, normale octaédrique
+const GLchar* FlagRenderer3D::PACKED_VERTEX_SHADER =
+"#version 330 core\n"
+CAMERA_UNIFORM_BLOCK_GLSL
+PACKED_VERTEX_GLSL
+GL_STRINGIFY(
+    layout(location = 0) in vec3 aVertexPosition;
+    layout(location = 1) in vec2 aVertexNormal;
+
+    uniform vec3 uBoxMin;
+    uniform vec3 uBoxSize;
+
+    out vec3 vFragPosition;
+    out vec3 vFragNormal;
+
+    void main() {
+        vec3 position = unpackPosition(aVertexPosition, uBoxMin, uBoxSize);
+        vFragPosition = vec3(MVP * vec4(position, 1));
+        vFragNormal = vec3(MV * vec4(unpackNormal(aVertexNormal), 0));
+        gl_Position = MVP * vec4(position, 1);
+    }
+);
+
 FlagRenderer3D::FlagRenderer3D(int gridWidth, int gridHeight):
     m_ProgramID(buildProgram(VERTEX_SHADER, FRAGMENT_SHADER)),
-    m_ProjMatrix(1.f), m_ViewMatrix(1.f),
-    m_nGridWidth(gridWidth), m_nGridHeight(gridHeight), m_nIndexCount(0),
-    m_VertexBuffer(gridWidth * gridHeight) {
-
-    // Création du VBO
-    glGenBuffers(1, &m_VBOID);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBOID);
+    m_GPUNormalsProgramID(buildProgram(GPU_NORMALS_VERTEX_SHADER, FRAGMENT_SHADER)),
+    m_PackedProgramID(buildProgram(PACKED_VERTEX_SHADER, FRAGMENT_SHADER)),
+    m_nGridWidth(gridWidth), m_nGridHeight(gridHeight), m_nIndexCount(0), m_IndexType(GL_UNSIGNED_INT),
+    m_Patches(buildGridPatches(gridWidth, gridHeight)),
+    m_nPatchColumnCount(gridPatchColumnCount(gridWidth)), m_nPatchRowCount(gridPatchRowCount(gridHeight)), m_bCulling(false),
+    m_VertexStream(gridWidth * gridHeight * sizeof(Vertex)),
+    m_PositionStream(gridWidth * gridHeight * sizeof(glm::vec3)),
+    m_VertexFormat(FLOAT_VERTICES), m_pVertices(nullptr), m_pPackedVertices(nullptr), m_bComputeBox(false),
+    m_PositionX(gridWidth * gridHeight + 4), m_PositionY(gridWidth * gridHeight + 4), m_PositionZ(gridWidth * gridHeight + 4),
+    m_nPaddedWidth(gridWidth + 1),
+    m_Triangle0X((gridWidth + 1) * (gridHeight + 1) + 4, 0.f), m_Triangle0Y((gridWidth + 1) * (gridHeight + 1) + 4, 0.f),
+    m_Triangle0Z((gridWidth + 1) * (gridHeight + 1) + 4, 0.f), m_Triangle1X((gridWidth + 1) * (gridHeight + 1) + 4, 0.f),
+    m_Triangle1Y((gridWidth + 1) * (gridHeight + 1) + 4, 0.f), m_Triangle1Z((gridWidth + 1) * (gridHeight + 1) + 4, 0.f) {
 
     glGenBuffers(1, &m_IBOID);
 
-    std::vector<GLuint> indexBuffer;
-    for(int j = 0; j < gridHeight - 1; ++j) {
-        for(int i = 0; i < gridWidth - 1; ++i) {
-            indexBuffer.push_back(i + j * gridWidth);
-            indexBuffer.push_back((i + 1) + j * gridWidth);
-            indexBuffer.push_back((i + 1) + (j + 1) * gridWidth);
-            indexBuffer.push_back(i + j * gridWidth);
-            indexBuffer.push_back((i + 1) + (j + 1) * gridWidth);
-            indexBuffer.push_back(i + (j + 1) * gridWidth);
-        }
-    }
-    m_nIndexCount = indexBuffer.size();
+    // Indices en bandes verticales (cache des sommets du GPU), sur 16 bits si la grille le permet
+    GridIndexBuffer indexBuffer(gridWidth, gridHeight);
+    m_nIndexCount = indexBuffer.count;
+    m_IndexType = indexBuffer.type;
+    m_nIndexSize = indexBuffer.indexSize();
+    m_PatchFirstIndices = indexBuffer.patchFirstIndices;
+    m_PatchIndexCounts = indexBuffer.patchIndexCounts;
 
     // Création du VAO
     glGenVertexArrays(1, &m_VAOID);
     glBindVertexArray(m_VAOID);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IBOID);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBuffer.size() * sizeof(indexBuffer[0]), indexBuffer.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBuffer.byteSize(), indexBuffer.data(), GL_STATIC_DRAW);
 
+    // Les pointeurs des attributs sont donnés à chaque draw, selon la zone du StreamBuffer utilisée
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*) offsetof(Vertex, position));
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*) offsetof(Vertex, normal));
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
-    m_uMVPMatrix = glGetUniformLocation(m_ProgramID, "uMVPMatrix");
-    m_uMVMatrix = glGetUniformLocation(m_ProgramID, "uMVMatrix");
+    // Matrices lues dans le bloc Camera (Graphics::CameraUniformBuffer)
+    Graphics::CameraUniformBuffer::bindProgram(m_ProgramID);
+    Graphics::CameraUniformBuffer::bindProgram(m_GPUNormalsProgramID);
+    Graphics::CameraUniformBuffer::bindProgram(m_PackedProgramID);
+
+    m_uPackedBoxMin = glGetUniformLocation(m_PackedProgramID, "uBoxMin");
+    m_uPackedBoxSize = glGetUniformLocation(m_PackedProgramID, "uBoxSize");
+
+    // Buffer texture des positions pour le calcul des normales sur le GPU
+    glGenTextures(1, &m_PositionTextureID);
+
+    // Aucun attribut: le VAO ne contient que l'index buffer
+    glGenVertexArrays(1, &m_GPUNormalsVAOID);
+    glBindVertexArray(m_GPUNormalsVAOID);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IBOID);
+    glBindVertexArray(0);
+
+    m_uGPUNormalsFirstPosition = glGetUniformLocation(m_GPUNormalsProgramID, "uFirstPosition");
+
+    glUseProgram(m_GPUNormalsProgramID);
+    glUniform1i(glGetUniformLocation(m_GPUNormalsProgramID, "uPositions"), 0);
+    glUniform1i(glGetUniformLocation(m_GPUNormalsProgramID, "uGridWidth"), gridWidth);
+    glUniform1i(glGetUniformLocation(m_GPUNormalsProgramID, "uGridHeight"), gridHeight);
+    glUseProgram(0);
 }
 
 FlagRenderer3D::~FlagRenderer3D() {
-    glDeleteBuffers(1, &m_VBOID);
     glDeleteBuffers(1, &m_IBOID);
     glDeleteVertexArrays(1, &m_VAOID);
     glDeleteProgram(m_ProgramID);
+
+    glDeleteTextures(1, &m_PositionTextureID);
+    glDeleteVertexArrays(1, &m_GPUNormalsVAOID);
+    glDeleteProgram(m_GPUNormalsProgramID);
+    glDeleteProgram(m_PackedProgramID);
 }
 
 void FlagRenderer3D::clear() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
-void FlagRenderer3D::drawGrid(const glm::vec3* positionArray, bool wireframe) {
-    glEnable(GL_DEPTH_TEST);
+namespace {
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBOID);
+// 4 flottants traités par instruction (extension vectorielle de GCC/Clang: SSE sur x86, NEON sur ARM)
+typedef float float4 __attribute__((vector_size(16)));
 
-    for(int j = 0; j < m_nGridHeight; ++j) {
-        for(int i = 0; i < m_nGridWidth; ++i) {
-            m_VertexBuffer[i + j * m_nGridWidth].position = positionArray[i + j * m_nGridWidth];
-            
-            glm::vec3 N(0.f);
+template<typename T> inline T load(const float* p);
+template<> inline float load<float>(const float* p) { return *p; }
+template<> inline float4 load<float4>(const float* p) { float4 v; std::memcpy(&v, p, sizeof(v)); return v; }
 
-            glm::vec3 A = positionArray[i + j * m_nGridWidth];
+inline void store(float* p, float v) { *p = v; }
+inline void store(float* p, const float4& v) { std::memcpy(p, &v, sizeof(v)); }
 
-            if(i > 0 && j > 0) {
-                glm::vec3 B = positionArray[(i - 1) + j * m_nGridWidth];
-                glm::vec3 C = positionArray[(i - 1) + (j - 1) * m_nGridWidth];
+template<typename T> struct LaneCount { static const int value = sizeof(T) / sizeof(float); };
 
-                glm::vec3 BxC = glm::cross(B - A, C - A);
-                float l = glm::length(BxC);
+// Nombre de points traités par bloc de lignes confié à un thread
+static const int POINTS_PER_TASK = 4096;
 
-                if(l > 0.0001f) {
-                    N += BxC / l;
-                }
-            }
+// Produits vectoriels des 2 triangles des cases d'indice k à k + lanes - 1 (coin (i, j) de la case),
+// rangés à partir de l'indice q de la grille bordée.
+// Triangle 0 = A B C, triangle 1 = A C D (ordre de l'index buffer) avec A = (i, j), B = (i+1, j), C = (i+1, j+1), D = (i, j+1)
+template<typename T>
+inline void quadNormals(const float* px, const float* py, const float* pz, int k, int gridWidth,
+                        float* t0x, float* t0y, float* t0z, float* t1x, float* t1y, float* t1z, int q) {
+    T ax = load<T>(px + k), ay = load<T>(py + k), az = load<T>(pz + k);
 
-            if(i > 0 && j > 0) {
-                glm::vec3 B = positionArray[(i - 1) + (j - 1) * m_nGridWidth];
-                glm::vec3 C = positionArray[i + (j - 1) * m_nGridWidth];
+    T abx = load<T>(px + k + 1) - ax, aby = load<T>(py + k + 1) - ay, abz = load<T>(pz + k + 1) - az;
+    T acx = load<T>(px + k + gridWidth + 1) - ax, acy = load<T>(py + k + gridWidth + 1) - ay, acz = load<T>(pz + k + gridWidth + 1) - az;
+    T adx = load<T>(px + k + gridWidth) - ax, ady = load<T>(py + k + gridWidth) - ay, adz = load<T>(pz + k + gridWidth) - az;
 
-                glm::vec3 BxC = glm::cross(B - A, C - A);
-                float l = glm::length(BxC);
+    store(t0x + q, aby * acz - abz * acy);
+    store(t0y + q, abz * acx - abx * acz);
+    store(t0z + q, abx * acy - aby * acx);
 
-                if(l > 0.0001f) {
-                    N += BxC / l;
-                }
-            }
+    store(t1x + q, acy * adz - acz * ady);
+    store(t1y + q, acz * adx - acx * adz);
+    store(t1z + q, acx * ady - acy * adx);
+}
 
-            if(i < m_nGridWidth - 1 && j > 0) {
-                glm::vec3 B = positionArray[i + (j - 1) * m_nGridWidth];
-                glm::vec3 C = positionArray[(i + 1) + (j - 1) * m_nGridWidth];
+// Somme des triangles adjacents au sommet d'indice q de la grille bordée: les 2 triangles de sa case,
+// le triangle 0 de la case de gauche, les 2 de la case en diagonale et le triangle 1 de la case du dessous
+template<typename T>
+inline T adjacentSum(const float* t0, const float* t1, int q, int paddedWidth) {
+    return load<T>(t0 + q) + load<T>(t1 + q)
+         + load<T>(t0 + q - 1)
+         + load<T>(t0 + q - 1 - paddedWidth) + load<T>(t1 + q - 1 - paddedWidth)
+         + load<T>(t1 + q - paddedWidth);
+}
 
-                glm::vec3 BxC = glm::cross(B - A, C - A);
-                float l = glm::length(BxC);
+}
 
-                if(l > 0.0001f) {
-                    N += BxC / l;
-                }
-            }
+void FlagRenderer3D::copyPositions(const glm::vec3* positionArray, uint32_t rowBegin, uint32_t rowEnd, uint32_t columnBegin, uint32_t columnEnd) {
+    for(uint32_t j = rowBegin; j < rowEnd; ++j) {
+        for(uint32_t k = columnBegin + j * m_nGridWidth; k < columnEnd + j * m_nGridWidth; ++k) {
+            m_PositionX[k] = positionArray[k].x;
+            m_PositionY[k] = positionArray[k].y;
+            m_PositionZ[k] = positionArray[k].z;
+        }
+    }
+    if(!m_bComputeBox) {
+        return;
+    }
 
-            if(i < m_nGridWidth - 1 && j > 0) {
-                glm::vec3 B = positionArray[(i + 1) + (j - 1) * m_nGridWidth];
-                glm::vec3 C = positionArray[(i + 1) + j * m_nGridWidth];
+    glm::vec3 boxMin(std::numeric_limits<float>::max()), boxMax(-std::numeric_limits<float>::max());
+    for(uint32_t j = rowBegin; j < rowEnd; ++j) {
+        for(uint32_t k = columnBegin + j * m_nGridWidth; k < columnEnd + j * m_nGridWidth; ++k) {
+            boxMin = glm::min(boxMin, positionArray[k]);
+            boxMax = glm::max(boxMax, positionArray[k]);
+        }
+    }
 
-                glm::vec3 BxC = glm::cross(B - A, C - A);
-                float l = glm::length(BxC);
+    std::lock_guard<std::mutex> lock(m_BoxMutex);
+    m_BoxMin = glm::min(m_BoxMin, boxMin);
+    m_BoxMax = glm::max(m_BoxMax, boxMax);
+}
 
-                if(l > 0.0001f) {
-                    N += BxC / l;
-                }
-            }
+void FlagRenderer3D::computeTriangleNormals(uint32_t rowBegin, uint32_t rowEnd, uint32_t columnBegin, uint32_t columnEnd) {
+    for(uint32_t j = rowBegin; j < rowEnd; ++j) {
+        int k = j * m_nGridWidth;
+        int q = 1 + (j + 1) * m_nPaddedWidth;
 
-            if(i < m_nGridWidth - 1 && j < m_nGridHeight - 1) {
-                glm::vec3 B = positionArray[(i + 1) + j * m_nGridWidth];
-                glm::vec3 C = positionArray[(i + 1) + (j + 1) * m_nGridWidth];
+        int i = columnBegin;
+        for(; i + LaneCount<float4>::value <= int(columnEnd); i += LaneCount<float4>::value) {
+            quadNormals<float4>(m_PositionX.data(), m_PositionY.data(), m_PositionZ.data(), k + i, m_nGridWidth,
+                                m_Triangle0X.data(), m_Triangle0Y.data(), m_Triangle0Z.data(),
+                                m_Triangle1X.data(), m_Triangle1Y.data(), m_Triangle1Z.data(), q + i);
+        }
+        // Dernières cases: la bordure (ou les cases d'un autre carré) ne doit pas être écrasée
+        for(; i < int(columnEnd); ++i) {
+            quadNormals<float>(m_PositionX.data(), m_PositionY.data(), m_PositionZ.data(), k + i, m_nGridWidth,
+                               m_Triangle0X.data(), m_Triangle0Y.data(), m_Triangle0Z.data(),
+                               m_Triangle1X.data(), m_Triangle1Y.data(), m_Triangle1Z.data(), q + i);
+        }
+    }
+}
 
-                glm::vec3 BxC = glm::cross(B - A, C - A);
-                float l = glm::length(BxC);
+void FlagRenderer3D::copyTriangleNormals(const glm::vec3* triangleNormalArray, uint32_t rowBegin, uint32_t rowEnd, uint32_t columnBegin, uint32_t columnEnd) {
+    for(uint32_t j = rowBegin; j < rowEnd; ++j) {
+        for(uint32_t i = columnBegin; i < columnEnd; ++i) {
+            int t = 2 * (i + j * (m_nGridWidth - 1));
+            int q = (i + 1) + (j + 1) * m_nPaddedWidth;
+            m_Triangle0X[q] = triangleNormalArray[t].x;
+            m_Triangle0Y[q] = triangleNormalArray[t].y;
+            m_Triangle0Z[q] = triangleNormalArray[t].z;
+            m_Triangle1X[q] = triangleNormalArray[t + 1].x;
+            m_Triangle1Y[q] = triangleNormalArray[t + 1].y;
+            m_Triangle1Z[q] = triangleNormalArray[t + 1].z;
+        }
+    }
+}
 
-                if(l > 0.0001f) {
-                    N += BxC / l;
+void FlagRenderer3D::gatherVertexNormals(uint32_t rowBegin, uint32_t rowEnd, uint32_t columnBegin, uint32_t columnEnd) {
+    static const int lanes = LaneCount<float4>::value;
+    float nx[lanes], ny[lanes], nz[lanes];
+
+    for(uint32_t j = rowBegin; j < rowEnd; ++j) {
+        int k = j * m_nGridWidth;
+        int q = 1 + (j + 1) * m_nPaddedWidth;
+
+        // Les lanes qui dépassent la zone lisent des cases voisines (ou la marge en fin de tableau)
+        // et ne sont simplement pas écrites
+        for(int i = columnBegin; i < int(columnEnd); i += lanes) {
+            store(nx, adjacentSum<float4>(m_Triangle0X.data(), m_Triangle1X.data(), q + i, m_nPaddedWidth));
+            store(ny, adjacentSum<float4>(m_Triangle0Y.data(), m_Triangle1Y.data(), q + i, m_nPaddedWidth));
+            store(nz, adjacentSum<float4>(m_Triangle0Z.data(), m_Triangle1Z.data(), q + i, m_nPaddedWidth));
+
+            int laneCount = std::min(lanes, int(columnEnd) - i);
+            for(int l = 0; l < laneCount; ++l) {
+                // Une normale nulle (triangles dégénérés) reste nulle
+                float invLength = 1.f / std::sqrt(std::max(nx[l] * nx[l] + ny[l] * ny[l] + nz[l] * nz[l], 1e-20f));
+                int vertex = k + i + l;
+                glm::vec3 position(m_PositionX[vertex], m_PositionY[vertex], m_PositionZ[vertex]);
+                glm::vec3 normal = glm::vec3(nx[l], ny[l], nz[l]) * invLength;
+                if(m_pPackedVertices) {
+                    m_Box.packPosition(position, m_pPackedVertices[vertex].position);
+                    packNormal(normal, m_pPackedVertices[vertex].normal);
+                } else {
+                    m_pVertices[vertex].position = position;
+                    m_pVertices[vertex].normal = normal;
                 }
             }
+        }
+    }
+}
+
+void FlagRenderer3D::setVisiblePatches(const std::vector<uint8_t>& visiblePatches) {
+    assert(visiblePatches.empty() || visiblePatches.size() == m_Patches.size());
 
-            if(i < m_nGridWidth - 1 && j < m_nGridHeight - 1) {
-                glm::vec3 B = positionArray[(i + 1) + (j + 1) * m_nGridWidth];
-                glm::vec3 C = positionArray[i + (j + 1) * m_nGridWidth];
+    m_VisibleFirstIndices.clear();
+    m_VisibleIndexCounts.clear();
+    m_bCulling = std::find(visiblePatches.begin(), visiblePatches.end(), 0) != visiblePatches.end();
+    if(!m_bCulling) {
+        return;
+    }
 
-                glm::vec3 BxC = glm::cross(B - A, C - A);
-                float l = glm::length(BxC);
+    for(size_t k = 0; k < m_Patches.size(); ++k) {
+        if(visiblePatches[k]) {
+            m_VisibleFirstIndices.push_back((const GLvoid*) (GLintptr(m_PatchFirstIndices[k]) * m_nIndexSize));
+            m_VisibleIndexCounts.push_back(m_PatchIndexCounts[k]);
+        }
+    }
 
-                if(l > 0.0001f) {
-                    N += BxC / l;
+    // Carrés à calculer pour chaque passe: un sommet dépend des cases voisines, qui dépendent des positions voisines.
+    // Chaque niveau ajoute les 8 carrés voisins de ceux du niveau précédent
+    std::vector<uint8_t> current(visiblePatches), dilated(visiblePatches.size());
+    for(int level = 0; level < 3; ++level) {
+        m_PassPatches[level].clear();
+        for(int x = 0; x < m_nPatchColumnCount; ++x) {
+            for(int y = 0; y < m_nPatchRowCount; ++y) {
+                uint8_t needed = 0;
+                for(int dx = std::max(0, x - 1); dx <= std::min(m_nPatchColumnCount - 1, x + 1); ++dx) {
+                    for(int dy = std::max(0, y - 1); dy <= std::min(m_nPatchRowCount - 1, y + 1); ++dy) {
+                        needed |= current[dx * m_nPatchRowCount + dy];
+                    }
+                }
+                dilated[x * m_nPatchRowCount + y] = needed;
+                if(needed) {
+                    m_PassPatches[level].push_back(x * m_nPatchRowCount + y);
                 }
             }
+        }
+        std::swap(current, dilated);
+    }
+}
 
-            if(i > 0 && j < m_nGridHeight - 1) {
-                glm::vec3 B = positionArray[i + (j + 1) * m_nGridWidth];
-                glm::vec3 C = positionArray[(i - 1) + (j + 1) * m_nGridWidth];
+template<typename Pass>
+void FlagRenderer3D::forEachRegion(int level, const Pass& pass) {
+    if(!m_bCulling) {
+        uint32_t rowsPerTask = std::max(1, POINTS_PER_TASK / m_nGridWidth);
+        ThreadPool::getDefault().parallelFor(m_nGridHeight, rowsPerTask, [&](uint32_t begin, uint32_t end) {
+            pass(begin, end, 0, m_nGridWidth);
+        });
+        return;
+    }
 
-                glm::vec3 BxC = glm::cross(B - A, C - A);
-                float l = glm::length(BxC);
+    // Points appartenant à chaque carré: ses cases, plus la dernière ligne / colonne de la grille pour les carrés du bord
+    const std::vector<uint32_t>& patches = m_PassPatches[level];
+    ThreadPool::getDefault().parallelFor(patches.size(), 1, [&](uint32_t begin, uint32_t end) {
+        for(uint32_t p = begin; p < end; ++p) {
+            const GridPatch& patch = m_Patches[patches[p]];
+            pass(patch.quadBeginJ, patch.quadEndJ + (patch.quadEndJ == m_nGridHeight - 1),
+                 patch.quadBeginI, patch.quadEndI + (patch.quadEndI == m_nGridWidth - 1));
+        }
+    });
+}
 
-                if(l > 0.0001f) {
-                    N += BxC / l;
-                }
-            }
+void FlagRenderer3D::drawElements() {
+    if(m_bCulling) {
+        glMultiDrawElements(GL_TRIANGLES, m_VisibleIndexCounts.data(), m_IndexType, m_VisibleFirstIndices.data(), m_VisibleIndexCounts.size());
+    } else {
+        glDrawElements(GL_TRIANGLES, m_nIndexCount, m_IndexType, 0);
+    }
+}
 
-            if(i > 0 && j < m_nGridHeight - 1) {
-                glm::vec3 B = positionArray[(i - 1) + (j + 1) * m_nGridWidth];
-                glm::vec3 C = positionArray[(i - 1) + j * m_nGridWidth];
+void FlagRenderer3D::mapVertices() {
+    GLsizeiptr vertexSize = m_VertexFormat == PACKED_VERTICES ? sizeof(PackedFlagVertex) : sizeof(Vertex);
+    void* pData = m_VertexStream.map(m_nGridWidth * m_nGridHeight * vertexSize);
+    m_pVertices = m_VertexFormat == PACKED_VERTICES ? nullptr : static_cast<Vertex*>(pData);
+    m_pPackedVertices = m_VertexFormat == PACKED_VERTICES ? static_cast<PackedFlagVertex*>(pData) : nullptr;
 
-                glm::vec3 BxC = glm::cross(B - A, C - A);
-                float l = glm::length(BxC);
+    m_BoxMin = glm::vec3(std::numeric_limits<float>::max());
+    m_BoxMax = glm::vec3(-std::numeric_limits<float>::max());
+}
 
-                if(l > 0.0001f) {
-                    N += BxC / l;
-                }
-            }
+void FlagRenderer3D::drawGrid(const glm::vec3* positionArray, bool wireframe) {
+    drawGridCPUNormals(positionArray, nullptr, nullptr, wireframe);
+}
 
-            m_VertexBuffer[i + j * m_nGridWidth].normal = N != glm::vec3(0.f) ? glm::normalize(N) : glm::vec3(0.f);
-        }
+void FlagRenderer3D::drawGrid(const glm::vec3* positionArray, const glm::vec3& AABBmin, const glm::vec3& AABBmax, bool wireframe) {
+    PackedFlagBox box(AABBmin, AABBmax);
+    drawGridCPUNormals(positionArray, nullptr, &box, wireframe);
+}
+
+void FlagRenderer3D::drawGrid(const glm::vec3* positionArray, const glm::vec3* triangleNormalArray, bool wireframe) {
+    drawGridCPUNormals(positionArray, triangleNormalArray, nullptr, wireframe);
+}
+
+void FlagRenderer3D::drawGrid(const glm::vec3* positionArray, const glm::vec3* triangleNormalArray,
+                              const glm::vec3& AABBmin, const glm::vec3& AABBmax, bool wireframe) {
+    PackedFlagBox box(AABBmin, AABBmax);
+    drawGridCPUNormals(positionArray, triangleNormalArray, &box, wireframe);
+}
+
+void FlagRenderer3D::drawGridCPUNormals(const glm::vec3* positionArray, const glm::vec3* triangleNormalArray,
+                                        const PackedFlagBox* pBox, bool wireframe) {
+    if(m_bCulling && m_VisibleIndexCounts.empty()) {
+        return;
     }
 
-    glBufferData(GL_ARRAY_BUFFER, m_VertexBuffer.size() * sizeof(m_VertexBuffer[0]), m_VertexBuffer.data(), GL_DYNAMIC_DRAW);
+    mapVertices();
 
-    glUseProgram(m_ProgramID);
+    // La boîte n'est calculée pendant la copie des positions que si les sommets sont compressés et qu'elle n'est pas fournie
+    m_bComputeBox = m_pPackedVertices && !pBox;
 
-    glUniformMatrix4fv(m_uMVPMatrix, 1, GL_FALSE, glm::value_ptr(m_ProjMatrix * m_ViewMatrix));
-    glUniformMatrix4fv(m_uMVMatrix, 1, GL_FALSE, glm::value_ptr(m_ViewMatrix));
+    if(triangleNormalArray) {
+        forEachRegion(1, [&](uint32_t rowBegin, uint32_t rowEnd, uint32_t columnBegin, uint32_t columnEnd) {
+            copyPositions(positionArray, rowBegin, rowEnd, columnBegin, columnEnd);
+            copyTriangleNormals(triangleNormalArray, rowBegin, std::min(rowEnd, uint32_t(m_nGridHeight - 1)),
+                                columnBegin, std::min(columnEnd, uint32_t(m_nGridWidth - 1)));
+        });
+    } else {
+        // Normale d'un sommet: somme des produits vectoriels (pondérés par l'aire) des 6 triangles adjacents.
+        // 3 passes séparées par une synchronisation: copie des positions, normales des triangles, puis regroupement par sommet
+        // (qui écrit les sommets directement dans le buffer du GPU)
+        forEachRegion(2, [&](uint32_t rowBegin, uint32_t rowEnd, uint32_t columnBegin, uint32_t columnEnd) {
+            copyPositions(positionArray, rowBegin, rowEnd, columnBegin, columnEnd);
+        });
+    }
+    m_Box = pBox ? *pBox : PackedFlagBox(m_BoxMin, m_BoxMax);
+
+    if(!triangleNormalArray) {
+        forEachRegion(1, [&](uint32_t rowBegin, uint32_t rowEnd, uint32_t columnBegin, uint32_t columnEnd) {
+            computeTriangleNormals(rowBegin, std::min(rowEnd, uint32_t(m_nGridHeight - 1)),
+                                   columnBegin, std::min(columnEnd, uint32_t(m_nGridWidth - 1)));
+        });
+    }
+    forEachRegion(0, [&](uint32_t rowBegin, uint32_t rowEnd, uint32_t columnBegin, uint32_t columnEnd) {
+        gatherVertexNormals(rowBegin, rowEnd, columnBegin, columnEnd);
+    });
+
+    draw(wireframe);
+}
+
+void FlagRenderer3D::drawGridGPUNormals(const glm::vec3* positionArray, bool wireframe) {
+    if(m_bCulling && m_VisibleIndexCounts.empty()) {
+        return;
+    }
+
+    glEnable(GL_DEPTH_TEST);
+
+    // Seules les positions sont envoyées, telles quelles
+    GLsizeiptr size = m_nGridWidth * m_nGridHeight * sizeof(glm::vec3);
+    std::memcpy(m_PositionStream.map(size), positionArray, size);
+    GLintptr offset = m_PositionStream.unmap();
+
+    glUseProgram(m_GPUNormalsProgramID);
+
+    glUniform1i(m_uGPUNormalsFirstPosition, offset / sizeof(float));
+
+    // Le buffer texture couvre tout le StreamBuffer (dont l'identifiant change s'il est agrandi)
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, m_PositionTextureID);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, m_PositionStream.getBufferID());
+
+    if(wireframe) {
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    } else {
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    }
+
+    glBindVertexArray(m_GPUNormalsVAOID);
+        drawElements();
+    glBindVertexArray(0);
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    m_PositionStream.fence();
+}
+
+void FlagRenderer3D::draw(bool wireframe) {
+    glEnable(GL_DEPTH_TEST);
+
+    GLintptr offset = m_VertexStream.unmap();
+    bool packed = m_pPackedVertices != nullptr;
+    m_pVertices = nullptr;
+    m_pPackedVertices = nullptr;
+
+    if(packed) {
+        glUseProgram(m_PackedProgramID);
+        glUniform3fv(m_uPackedBoxMin, 1, glm::value_ptr(m_Box.min));
+        glUniform3fv(m_uPackedBoxSize, 1, glm::value_ptr(m_Box.size));
+    } else {
+        glUseProgram(m_ProgramID);
+    }
 
     if(wireframe) {
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -220,8 +541,19 @@ void FlagRenderer3D::drawGrid(const glm::vec3* positionArray, bool wireframe) {
     }
 
     glBindVertexArray(m_VAOID);
-        glDrawElements(GL_TRIANGLES, m_nIndexCount, GL_UNSIGNED_INT, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, m_VertexStream.getBufferID());
+        if(packed) {
+            PackedFlagVertex::setAttribPointers(0, 1, offset);
+        } else {
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*) (offset + offsetof(Vertex, position)));
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*) (offset + offsetof(Vertex, normal)));
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        drawElements();
     glBindVertexArray(0);
+
+    m_VertexStream.fence();
 }
 
 }
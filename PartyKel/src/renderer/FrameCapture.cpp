@@ -0,0 +1,191 @@
+#include "PartyKel/renderer/FrameCapture.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace PartyKel {
+
+namespace {
+
+// Vrai si pattern contient exactement une conversion entière sans modificateur de longueur (d, i, u, o, x ou X,
+// avec drapeaux, largeur et précision littérales), en plus des %% littéraux: le seul argument passé est le numéro de l'image
+bool isValidFilePattern(const std::string& pattern) {
+    uint32_t conversionCount = 0;
+    for(size_t i = 0; i < pattern.size(); ++i) {
+        if(pattern[i] != '%') {
+            continue;
+        }
+        if(++i < pattern.size() && pattern[i] == '%') {
+            continue;
+        }
+
+        while(i < pattern.size() && std::strchr("-+ #0", pattern[i])) {
+            ++i;
+        }
+        while(i < pattern.size() && pattern[i] >= '0' && pattern[i] <= '9') {
+            ++i;
+        }
+        if(i < pattern.size() && pattern[i] == '.') {
+            ++i;
+            while(i < pattern.size() && pattern[i] >= '0' && pattern[i] <= '9') {
+                ++i;
+            }
+        }
+        if(i == pattern.size() || !std::strchr("diuoxX", pattern[i])) {
+            return false;
+        }
+        ++conversionCount;
+    }
+    return conversionCount == 1;
+}
+
+}
+
+FrameCapture::FrameCapture(GLsizei width, GLsizei height, const std::string& filePattern):
+    m_nWidth(width), m_nHeight(height), m_FilePattern(filePattern),
+    m_nFrameCount(0), m_nRetrievedCount(0), m_nWritingCount(0), m_bStop(false) {
+
+    // Le motif est passé tel quel à snprintf par le thread d'écriture
+    if(!isValidFilePattern(filePattern)) {
+        throw std::runtime_error("FrameCapture: the file pattern \"" + filePattern
+                                 + "\" must contain exactly one integer conversion (for example %05d) for the frame number");
+    }
+
+    glGenBuffers(2, m_PBOIDs);
+    for(GLuint pbo : m_PBOIDs) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, GLsizeiptr(width) * height * 4, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_writer = std::thread(&FrameCapture::writerLoop, this);
+}
+
+FrameCapture::~FrameCapture() {
+    finish();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bStop = true;
+    }
+    m_wakeCondition.notify_all();
+    m_writer.join();
+
+    glDeleteBuffers(2, m_PBOIDs);
+}
+
+void FrameCapture::capture() {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBOIDs[m_nFrameCount % 2]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, m_nWidth, m_nHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    ++m_nFrameCount;
+
+    // L'image précédente a eu une frame pour arriver dans l'autre PBO (sauf si finish() l'a déjà récupérée)
+    if(m_nFrameCount >= 2 && m_nRetrievedCount < m_nFrameCount - 1) {
+        retrieve(m_nFrameCount - 2);
+    }
+}
+
+void FrameCapture::finish() {
+    if(m_nRetrievedCount < m_nFrameCount) {
+        retrieve(m_nFrameCount - 1);
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this]() {
+        return m_queue.empty() && m_nWritingCount == 0;
+    });
+}
+
+uint32_t FrameCapture::getPendingFrameCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size() + m_nWritingCount;
+}
+
+void FrameCapture::retrieve(uint32_t index) {
+    Frame frame;
+    frame.index = index;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_freeBuffers.empty()) {
+            frame.pixels.swap(m_freeBuffers.back());
+            m_freeBuffers.pop_back();
+        }
+    }
+
+    size_t size = size_t(m_nWidth) * m_nHeight * 4;
+    frame.pixels.resize(size);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBOIDs[index % 2]);
+    const void* pData = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if(pData) {
+        std::memcpy(frame.pixels.data(), pData, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        std::cerr << "FrameCapture: unable to map the pixels of frame " << index << std::endl;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_nRetrievedCount = index + 1;
+
+    if(!pData) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(frame));
+    }
+    m_wakeCondition.notify_one();
+}
+
+void FrameCapture::writerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true) {
+        m_wakeCondition.wait(lock, [this]() {
+            return m_bStop || !m_queue.empty();
+        });
+        if(m_queue.empty()) {
+            return; // m_bStop
+        }
+
+        Frame frame = std::move(m_queue.front());
+        m_queue.pop_front();
+        ++m_nWritingCount;
+
+        lock.unlock();
+        writeFrame(frame);
+        lock.lock();
+
+        m_freeBuffers.push_back(std::move(frame.pixels));
+        --m_nWritingCount;
+        m_doneCondition.notify_all();
+    }
+}
+
+void FrameCapture::writeFrame(const Frame& frame) const {
+    char path[1024];
+    std::snprintf(path, sizeof(path), m_FilePattern.c_str(), unsigned(frame.index));
+
+    FILE* pFile = std::fopen(path, "wb");
+    if(!pFile) {
+        std::cerr << "FrameCapture: unable to open " << path << std::endl;
+        return;
+    }
+
+    // PPM binaire: RGB, lignes de haut en bas
+    std::fprintf(pFile, "P6\n%d %d\n255\n", m_nWidth, m_nHeight);
+    std::vector<uint8_t> row(m_nWidth * 3);
+    for(GLsizei y = m_nHeight - 1; y >= 0; --y) {
+        const uint8_t* pPixel = frame.pixels.data() + size_t(y) * m_nWidth * 4;
+        for(GLsizei x = 0; x < m_nWidth; ++x) {
+            row[3 * x] = pPixel[4 * x];
+            row[3 * x + 1] = pPixel[4 * x + 1];
+            row[3 * x + 2] = pPixel[4 * x + 2];
+        }
+        std::fwrite(row.data(), 1, row.size(), pFile);
+    }
+    std::fclose(pFile);
+}
+
+}
@@ -0,0 +1,49 @@
+#include "PartyKel/renderer/FramebufferTarget.hpp"
+
+#include <stdexcept>
+
+namespace PartyKel {
+
+FramebufferTarget::FramebufferTarget(GLsizei width, GLsizei height):
+    m_nWidth(width), m_nHeight(height) {
+
+    glGenRenderbuffers(1, &m_ColorRenderbufferID);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_ColorRenderbufferID);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &m_DepthRenderbufferID);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_DepthRenderbufferID);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_FramebufferID);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorRenderbufferID);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_DepthRenderbufferID);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if(status != GL_FRAMEBUFFER_COMPLETE) {
+        glDeleteFramebuffers(1, &m_FramebufferID);
+        glDeleteRenderbuffers(1, &m_ColorRenderbufferID);
+        glDeleteRenderbuffers(1, &m_DepthRenderbufferID);
+        throw std::runtime_error("Incomplete offscreen framebuffer");
+    }
+}
+
+FramebufferTarget::~FramebufferTarget() {
+    glDeleteFramebuffers(1, &m_FramebufferID);
+    glDeleteRenderbuffers(1, &m_ColorRenderbufferID);
+    glDeleteRenderbuffers(1, &m_DepthRenderbufferID);
+}
+
+void FramebufferTarget::bind() {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID);
+    glViewport(0, 0, m_nWidth, m_nHeight);
+}
+
+void FramebufferTarget::unbind() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+}
@@ -1,10 +1,17 @@
 #include "PartyKel/renderer/GLtools.hpp"
+#include "graphics/ProgramBinaryCache.h"
 
 #include <iostream>
 
 namespace PartyKel {
 
 GLuint buildProgram(const GLchar* vertexShaderSource, const GLchar* fragmentShaderSource) {
+    // Programme déjà compilé lors d'une exécution précédente avec les mêmes sources et le même driver
+    std::string cacheKey = Graphics::ProgramBinaryCache::key({vertexShaderSource, fragmentShaderSource});
+    GLuint cachedProgram = Graphics::ProgramBinaryCache::load(cacheKey);
+    if(cachedProgram != 0)
+        return cachedProgram;
+
     // Creation d'un Vertex Shader
     GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
 
@@ -78,6 +85,7 @@ GLuint buildProgram(const GLchar* vertexShaderSource, const GLchar* fragmentShad
     glDeleteShader(fragmentShader);
 
     // Edition de lien
+    Graphics::ProgramBinaryCache::prepare(program);
     glLinkProgram(program);
 
     /// Vérification que l'édition de liens a bien fonctionnée (très important aussi !)
@@ -98,6 +106,8 @@ GLuint buildProgram(const GLchar* vertexShaderSource, const GLchar* fragmentShad
         return 0;
     }
 
+    Graphics::ProgramBinaryCache::store(cacheKey, program);
+
     return program;
 }
 
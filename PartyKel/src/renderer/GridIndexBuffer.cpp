@@ -0,0 +1,50 @@
+#include "PartyKel/renderer/GridIndexBuffer.hpp"
+
+#include <algorithm>
+
+namespace PartyKel {
+
+namespace {
+
+template<typename T>
+void buildIndices(int gridWidth, int gridHeight, int blockWidth, std::vector<T>& indices) {
+    indices.reserve(6 * (gridWidth - 1) * (gridHeight - 1));
+    for(int blockBegin = 0; blockBegin < gridWidth - 1; blockBegin += blockWidth) {
+        int blockEnd = std::min(blockBegin + blockWidth, gridWidth - 1);
+        for(int j = 0; j < gridHeight - 1; ++j) {
+            for(int i = blockBegin; i < blockEnd; ++i) {
+                indices.push_back(i + j * gridWidth);
+                indices.push_back((i + 1) + j * gridWidth);
+                indices.push_back((i + 1) + (j + 1) * gridWidth);
+                indices.push_back(i + j * gridWidth);
+                indices.push_back((i + 1) + (j + 1) * gridWidth);
+                indices.push_back(i + (j + 1) * gridWidth);
+            }
+        }
+    }
+}
+
+}
+
+GridIndexBuffer::GridIndexBuffer(int gridWidth, int gridHeight, int blockWidth):
+    type(gridWidth * gridHeight <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT), count(0) {
+
+    blockWidth = std::max(1, blockWidth);
+    if(type == GL_UNSIGNED_SHORT) {
+        buildIndices(gridWidth, gridHeight, blockWidth, shortIndices);
+        count = shortIndices.size();
+    } else {
+        buildIndices(gridWidth, gridHeight, blockWidth, intIndices);
+        count = intIndices.size();
+    }
+
+    // Une bande contient toutes les lignes de ses cases: un carré commence après les bandes à sa gauche
+    // et les lignes du dessous de sa bande
+    for(const GridPatch& patch : buildGridPatches(gridWidth, gridHeight, blockWidth)) {
+        GLsizei stripWidth = patch.quadEndI - patch.quadBeginI;
+        patchFirstIndices.push_back(6 * (patch.quadBeginI * (gridHeight - 1) + stripWidth * patch.quadBeginJ));
+        patchIndexCounts.push_back(6 * stripWidth * (patch.quadEndJ - patch.quadBeginJ));
+    }
+}
+
+}
@@ -0,0 +1,120 @@
+#include "PartyKel/renderer/GridSubdivider.hpp"
+#include "PartyKel/ThreadPool.hpp"
+#include "geometry/Interpolation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace PartyKel {
+
+namespace {
+
+// 4 flottants traités par instruction (extension vectorielle de GCC/Clang: SSE sur x86, NEON sur ARM)
+typedef float float4 __attribute__((vector_size(16)));
+
+inline float4 load(const float* p) { float4 v; std::memcpy(&v, p, sizeof(v)); return v; }
+inline float4 splat(float x) { float4 v = {x, x, x, x}; return v; }
+
+// Nombre de points fins calculés par bloc de lignes confié à un thread
+static const int POINTS_PER_TASK = 4096;
+
+}
+
+GridSubdivider::GridSubdivider(int coarseWidth, int coarseHeight, int fineWidth, int fineHeight):
+    m_nCoarseWidth(coarseWidth), m_nCoarseHeight(coarseHeight), m_nFineWidth(fineWidth), m_nFineHeight(fineHeight),
+    m_ColumnStencils(buildStencils(coarseWidth, fineWidth)), m_RowStencils(buildStencils(coarseHeight, fineHeight)),
+    m_RowX(fineWidth * coarseHeight), m_RowY(fineWidth * coarseHeight), m_RowZ(fineWidth * coarseHeight),
+    m_FinePositions(fineWidth * fineHeight) {
+}
+
+std::vector<GridSubdivider::Stencil> GridSubdivider::buildStencils(int coarseCount, int fineCount) {
+    assert(coarseCount >= 2 && fineCount >= 2);
+
+    std::vector<Stencil> stencils(fineCount);
+    for(int f = 0; f < fineCount; ++f) {
+        // Segment [i, i + 1] de la grille grossière contenant le point fin, et position t dans ce segment
+        float u = float(f * (coarseCount - 1)) / (fineCount - 1);
+        int i = std::min(int(u), coarseCount - 2);
+        float w[4];
+        Geometry::cubicInterpolationWeights(u - i, w);
+
+        // Les 4 points du stencil restent dans la grille: les points extrapolés sont reportés sur les 2 points du bord
+        Stencil& stencil = stencils[f];
+        stencil.first = coarseCount >= 4 ? std::max(0, std::min(i - 1, coarseCount - 4)) : 0;
+        std::fill(stencil.weights, stencil.weights + 4, 0.f);
+        for(int k = 0; k < 4; ++k) {
+            int index = i - 1 + k;
+            if(index < 0) {
+                stencil.weights[0 - stencil.first] += 2.f * w[k];
+                stencil.weights[1 - stencil.first] -= w[k];
+            } else if(index >= coarseCount) {
+                stencil.weights[coarseCount - 1 - stencil.first] += 2.f * w[k];
+                stencil.weights[coarseCount - 2 - stencil.first] -= w[k];
+            } else {
+                stencil.weights[index - stencil.first] += w[k];
+            }
+        }
+    }
+    return stencils;
+}
+
+void GridSubdivider::interpolateRows(const glm::vec3* coarsePositionArray, uint32_t rowBegin, uint32_t rowEnd) {
+    for(uint32_t j = rowBegin; j < rowEnd; ++j) {
+        const glm::vec3* pRow = coarsePositionArray + j * m_nCoarseWidth;
+        for(int x = 0; x < m_nFineWidth; ++x) {
+            const Stencil& stencil = m_ColumnStencils[x];
+            glm::vec3 p(0.f);
+            for(int k = 0; k < 4; ++k)
+                p += stencil.weights[k] * pRow[std::min(stencil.first + k, m_nCoarseWidth - 1)];
+            m_RowX[x + j * m_nFineWidth] = p.x;
+            m_RowY[x + j * m_nFineWidth] = p.y;
+            m_RowZ[x + j * m_nFineWidth] = p.z;
+        }
+    }
+}
+
+void GridSubdivider::interpolateColumns(uint32_t rowBegin, uint32_t rowEnd) {
+    for(uint32_t j = rowBegin; j < rowEnd; ++j) {
+        const Stencil& stencil = m_RowStencils[j];
+        int rows[4];
+        float4 w[4];
+        for(int k = 0; k < 4; ++k) {
+            rows[k] = std::min(stencil.first + k, m_nCoarseHeight - 1) * m_nFineWidth;
+            w[k] = splat(stencil.weights[k]);
+        }
+
+        glm::vec3* pFine = m_FinePositions.data() + j * m_nFineWidth;
+        int x = 0;
+        for(; x + 4 <= m_nFineWidth; x += 4) {
+            float4 px = splat(0.f), py = splat(0.f), pz = splat(0.f);
+            for(int k = 0; k < 4; ++k) {
+                px += w[k] * load(&m_RowX[rows[k] + x]);
+                py += w[k] * load(&m_RowY[rows[k] + x]);
+                pz += w[k] * load(&m_RowZ[rows[k] + x]);
+            }
+            for(int lane = 0; lane < 4; ++lane)
+                pFine[x + lane] = glm::vec3(px[lane], py[lane], pz[lane]);
+        }
+        for(; x < m_nFineWidth; ++x) {
+            glm::vec3 p(0.f);
+            for(int k = 0; k < 4; ++k)
+                p += stencil.weights[k] * glm::vec3(m_RowX[rows[k] + x], m_RowY[rows[k] + x], m_RowZ[rows[k] + x]);
+            pFine[x] = p;
+        }
+    }
+}
+
+const glm::vec3* GridSubdivider::subdivide(const glm::vec3* coarsePositionArray) {
+    uint32_t rowsPerTask = std::max(1, POINTS_PER_TASK / m_nFineWidth);
+    ThreadPool& threadPool = ThreadPool::getDefault();
+    threadPool.parallelFor(m_nCoarseHeight, rowsPerTask, [&](uint32_t begin, uint32_t end) {
+        interpolateRows(coarsePositionArray, begin, end);
+    });
+    threadPool.parallelFor(m_nFineHeight, rowsPerTask, [&](uint32_t begin, uint32_t end) {
+        interpolateColumns(begin, end);
+    });
+    return m_FinePositions.data();
+}
+
+}
@@ -2,21 +2,27 @@
 #include "PartyKel/renderer/GLtools.hpp"
 #include "PartyKel/glm.hpp"
 
+#include <cstring>
+
 namespace PartyKel {
 
 const GLchar* Renderer2D::VERTEX_SHADER =
 "#version 330 core\n"
 GL_STRINGIFY(
     layout(location = 0) in vec2 aVertexPosition;
+    layout(location = 1) in vec2 aParticlePosition;
+    layout(location = 2) in float aParticleMass;
+    layout(location = 3) in vec3 aParticleColor;
 
-    uniform vec2 uParticlePosition;
-    uniform float uParticleScale;
+    uniform float uMassScale;
 
     out vec2 vFragPosition;
+    flat out vec3 vFragColor;
 
     void main() {
         vFragPosition = aVertexPosition;
-        gl_Position = vec4(uParticlePosition + uParticleScale * aVertexPosition, 0.f, 1.f);
+        vFragColor = aParticleColor;
+        gl_Position = vec4(aParticlePosition + uMassScale * aParticleMass * aVertexPosition, 0.f, 1.f);
     }
 );
 
@@ -24,11 +30,10 @@ const GLchar* Renderer2D::FRAGMENT_SHADER =
 "#version 330 core\n"
 GL_STRINGIFY(
     in vec2 vFragPosition;
+    flat in vec3 vFragColor;
 
     out vec4 fFragColor;
 
-    uniform vec3 uParticleColor;
-
     float computeAttenuation(float distance) {
         return 3.f * exp(-distance * distance * 9.f);
     }
@@ -36,7 +41,7 @@ GL_STRINGIFY(
     void main() {
         float distance = length(vFragPosition);
         float attenuation = computeAttenuation(distance);
-        fFragColor = vec4(uParticleColor, attenuation);
+        fFragColor = vec4(vFragColor, attenuation);
     }
 );
 
@@ -91,12 +96,17 @@ GL_STRINGIFY(
 Renderer2D::Renderer2D():
     m_ProgramID(buildProgram(VERTEX_SHADER, FRAGMENT_SHADER)),
     m_PolygonProgramID(buildProgram(POLYGON_VERTEX_SHADER, POLYGON_FRAGMENT_SHADER)),
-    m_LineProgramID(buildProgram(LINE_VERTEX_SHADER, LINE_FRAGMENT_SHADER)) {
+    m_LineProgramID(buildProgram(LINE_VERTEX_SHADER, LINE_FRAGMENT_SHADER)),
+    m_PolygonStream(1024 * sizeof(glm::vec2)),
+    m_LinePositionStream(1024 * sizeof(glm::vec2)),
+    m_LineColorStream(1024 * sizeof(glm::vec3)),
+    m_LineIndexStream(1024 * sizeof(std::pair<unsigned int, unsigned int>)),
+    m_ParticlePositionStream(1024 * sizeof(glm::vec2)),
+    m_ParticleMassStream(1024 * sizeof(float)),
+    m_ParticleColorStream(1024 * sizeof(glm::vec3)) {
 
     // Récuperation des uniforms
-    m_uParticleColor = glGetUniformLocation(m_ProgramID, "uParticleColor");
-    m_uParticlePosition = glGetUniformLocation(m_ProgramID, "uParticlePosition");
-    m_uParticleScale = glGetUniformLocation(m_ProgramID, "uParticleScale");
+    m_uMassScale = glGetUniformLocation(m_ProgramID, "uMassScale");
 
     m_uPolygonColor = glGetUniformLocation(m_PolygonProgramID, "uPolygonColor");
 
@@ -121,36 +131,30 @@ Renderer2D::Renderer2D():
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
 
+    // Attributs par particule: une valeur par instance du carré, pointeurs donnés à chaque draw
+    for(GLuint attrib = 1; attrib <= 3; ++attrib) {
+        glEnableVertexAttribArray(attrib);
+        glVertexAttribDivisor(attrib, 1);
+    }
+
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
-    glGenBuffers(1, &m_PolygonVBOID);
-    glBindBuffer(GL_ARRAY_BUFFER, m_PolygonVBOID);
+    // Les pointeurs des attributs des polygones et des lignes sont donnés à chaque draw,
+    // selon la zone du StreamBuffer utilisée
     glGenVertexArrays(1, &m_PolygonVAOID);
     glBindVertexArray(m_PolygonVAOID);
 
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
-    glGenBuffers(1, &m_LinePositionVBOID);
-    glGenBuffers(1, &m_LineColorVBOID);
-    glGenBuffers(1, &m_LineIBOID);
-
     glGenVertexArrays(1, &m_LineVAOID);
     glBindVertexArray(m_LineVAOID);
 
     glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, m_LinePositionVBOID);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
-
     glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, m_LineColorVBOID);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 }
 
@@ -160,9 +164,9 @@ Renderer2D::~Renderer2D() {
     glDeleteProgram(m_LineProgramID);
 
     glDeleteBuffers(1, &m_VBOID);
-    glDeleteBuffers(1, &m_PolygonVBOID);
     glDeleteVertexArrays(1, &m_VAOID);
     glDeleteVertexArrays(1, &m_PolygonVAOID);
+    glDeleteVertexArrays(1, &m_LineVAOID);
 }
 
 void Renderer2D::clear() {
@@ -175,6 +179,19 @@ void Renderer2D::drawParticles(
         const float* massArray,
         const glm::vec3* colorArray,
         float massScale) {
+    if(count == 0)
+        return;
+
+    // Les tableaux du ParticleManager2D sont copiés tels quels
+    std::memcpy(m_ParticlePositionStream.map(count * sizeof(positionArray[0])), positionArray, count * sizeof(positionArray[0]));
+    GLintptr positionOffset = m_ParticlePositionStream.unmap();
+
+    std::memcpy(m_ParticleMassStream.map(count * sizeof(massArray[0])), massArray, count * sizeof(massArray[0]));
+    GLintptr massOffset = m_ParticleMassStream.unmap();
+
+    std::memcpy(m_ParticleColorStream.map(count * sizeof(colorArray[0])), colorArray, count * sizeof(colorArray[0]));
+    GLintptr colorOffset = m_ParticleColorStream.unmap();
+
     // Active la gestion de la transparence
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -183,27 +200,36 @@ void Renderer2D::drawParticles(
 
     glUseProgram(m_ProgramID);
 
+    glUniform1f(m_uMassScale, massScale);
+
     glBindVertexArray(m_VAOID);
 
-    // Dessine chacune des particules
-    for(uint32_t i = 0; i < count; ++i) {
-        glUniform3fv(m_uParticleColor, 1, glm::value_ptr(colorArray[i]));
-        glUniform2fv(m_uParticlePosition, 1, glm::value_ptr(positionArray[i]));
-        glUniform1f(m_uParticleScale, massScale * massArray[i]);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-    }
+    glBindBuffer(GL_ARRAY_BUFFER, m_ParticlePositionStream.getBufferID());
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (const GLvoid*) positionOffset);
+    glBindBuffer(GL_ARRAY_BUFFER, m_ParticleMassStream.getBufferID());
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 0, (const GLvoid*) massOffset);
+    glBindBuffer(GL_ARRAY_BUFFER, m_ParticleColorStream.getBufferID());
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 0, (const GLvoid*) colorOffset);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Toutes les particules en un seul draw
+    glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, count);
 
     glBindVertexArray(0);
 
     glDisable(GL_BLEND);
+
+    m_ParticlePositionStream.fence();
+    m_ParticleMassStream.fence();
+    m_ParticleColorStream.fence();
 }
 
 void Renderer2D::drawPolygon(uint32_t count,
                  const glm::vec2* position,
                  const glm::vec3& color,
                  float lineWidth) {
-    glBindBuffer(GL_ARRAY_BUFFER, m_PolygonVBOID);
-    glBufferData(GL_ARRAY_BUFFER, count * sizeof(position[0]), position, GL_DYNAMIC_DRAW);
+    std::memcpy(m_PolygonStream.map(count * sizeof(position[0])), position, count * sizeof(position[0]));
+    GLintptr offset = m_PolygonStream.unmap();
 
     glDisable(GL_DEPTH_TEST);
 
@@ -213,10 +239,16 @@ void Renderer2D::drawPolygon(uint32_t count,
 
     glBindVertexArray(m_PolygonVAOID);
 
+    glBindBuffer(GL_ARRAY_BUFFER, m_PolygonStream.getBufferID());
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (const GLvoid*) offset);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
     glUniform3fv(m_uPolygonColor, 1, glm::value_ptr(color));
     glDrawArrays(GL_LINE_LOOP, 0, count);
 
     glBindVertexArray(0);
+
+    m_PolygonStream.fence();
 }
 
 void Renderer2D::drawLines(
@@ -226,11 +258,11 @@ void Renderer2D::drawLines(
                            const glm::vec2* positionArray,
                            const glm::vec3* colorArray,
                            float lineWidth) {
-    glBindBuffer(GL_ARRAY_BUFFER, m_LinePositionVBOID);
-    glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(positionArray[0]), positionArray, GL_DYNAMIC_DRAW);
+    std::memcpy(m_LinePositionStream.map(vertexCount * sizeof(positionArray[0])), positionArray, vertexCount * sizeof(positionArray[0]));
+    GLintptr positionOffset = m_LinePositionStream.unmap();
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_LineColorVBOID);
-    glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(colorArray[0]), colorArray, GL_DYNAMIC_DRAW);
+    std::memcpy(m_LineColorStream.map(vertexCount * sizeof(colorArray[0])), colorArray, vertexCount * sizeof(colorArray[0]));
+    GLintptr colorOffset = m_LineColorStream.unmap();
 
     glDisable(GL_DEPTH_TEST);
 
@@ -240,12 +272,24 @@ void Renderer2D::drawLines(
 
     glBindVertexArray(m_LineVAOID);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_LineIBOID);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, lineCount * sizeof(lines[0]), lines, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, m_LinePositionStream.getBufferID());
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (const GLvoid*) positionOffset);
+    glBindBuffer(GL_ARRAY_BUFFER, m_LineColorStream.getBufferID());
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (const GLvoid*) colorOffset);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Avec le VAO des lignes lié: l'index buffer fait partie de son état
+    std::memcpy(m_LineIndexStream.map(lineCount * sizeof(lines[0])), lines, lineCount * sizeof(lines[0]));
+    GLintptr indexOffset = m_LineIndexStream.unmap();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_LineIndexStream.getBufferID());
 
-    glDrawElements(GL_LINES, lineCount * 2, GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_LINES, lineCount * 2, GL_UNSIGNED_INT, (const GLvoid*) indexOffset);
 
     glBindVertexArray(0);
+
+    m_LinePositionStream.fence();
+    m_LineColorStream.fence();
+    m_LineIndexStream.fence();
 }
 
 }
@@ -1,25 +1,33 @@
 #include "PartyKel/renderer/Renderer3D.hpp"
 #include "PartyKel/renderer/GLtools.hpp"
 #include "PartyKel/renderer/Sphere.hpp"
+#include "graphics/CameraUniformBuffer.h"
+
+#include <algorithm>
 
 namespace PartyKel {
 
+// Une instance par sphère: position, rayon et couleur sont des attributs d'instance
 const GLchar* Renderer3D::SPHERE_VERTEX_SHADER =
 "#version 330 core\n"
+CAMERA_UNIFORM_BLOCK_GLSL
 GL_STRINGIFY(
     layout(location = 0) in vec3 aVertexPosition;
     layout(location = 1) in vec3 aVertexNormal;
-
-    uniform mat4 uMVPMatrix;
-    uniform mat4 uMVMatrix;
+    layout(location = 2) in vec3 aInstancePosition;
+    layout(location = 3) in vec3 aInstanceColor;
+    layout(location = 4) in float aInstanceScale;
 
     out vec3 vFragPositionViewSpace;
     out vec3 vFragNormalViewSpace;
+    flat out vec3 vFragColor;
 
     void main() {
-        vFragPositionViewSpace = vec3(uMVMatrix * vec4(aVertexPosition, 1));
-        vFragNormalViewSpace = vec3(uMVMatrix * vec4(aVertexNormal, 0));
-        gl_Position = uMVPMatrix * vec4(aVertexPosition, 1);
+        vec4 positionViewSpace = MV * vec4(aInstancePosition + aInstanceScale * aVertexPosition, 1);
+        vFragPositionViewSpace = vec3(positionViewSpace);
+        vFragNormalViewSpace = vec3(MV * vec4(aVertexNormal, 0));
+        vFragColor = aInstanceColor;
+        gl_Position = Projection * positionViewSpace;
     }
 );
 
@@ -28,22 +36,91 @@ const GLchar* Renderer3D::SPHERE_FRAGMENT_SHADER =
 GL_STRINGIFY(
     in vec3 vFragPositionViewSpace;
     in vec3 vFragNormalViewSpace;
+    flat in vec3 vFragColor;
+
+    out vec3 fFragColor;
+
+    void main() {
+        fFragColor = vFragColor * vec3(abs(dot(normalize(vFragPositionViewSpace), normalize(vFragNormalViewSpace))));
+    }
+);
+
+// Le carré est placé au centre de la sphère, perpendiculaire au rayon de vue, et assez grand pour
+// couvrir le cône tangent à la sphère depuis la caméra: demi-côté r * d / sqrt(d^2 - r^2)
+const GLchar* Renderer3D::IMPOSTOR_VERTEX_SHADER =
+"#version 330 core\n"
+CAMERA_UNIFORM_BLOCK_GLSL
+GL_STRINGIFY(
+    layout(location = 0) in vec2 aCorner;
+    layout(location = 2) in vec3 aInstancePosition;
+    layout(location = 3) in vec3 aInstanceColor;
+    layout(location = 4) in float aInstanceScale;
 
-    uniform vec3 uParticleColor;
+    out vec3 vFragPositionViewSpace;
+    flat out vec3 vSphereCenterViewSpace;
+    flat out float vSphereRadius;
+    flat out vec3 vFragColor;
+
+    void main() {
+        vec3 center = vec3(MV * vec4(aInstancePosition, 1));
+        float d2 = dot(center, center);
+        float r2 = aInstanceScale * aInstanceScale;
+
+        vec3 w = center * inversesqrt(d2);
+        vec3 up = abs(w.y) > 0.99f ? vec3(1, 0, 0) : vec3(0, 1, 0);
+        vec3 u = normalize(cross(up, w));
+        vec3 v = cross(w, u);
+
+        // Caméra à l'intérieur de la sphère: carré dégénéré
+        float halfSize = d2 > r2 ? aInstanceScale * sqrt(d2 / (d2 - r2)) : 0.f;
+
+        vFragPositionViewSpace = center + halfSize * (aCorner.x * u + aCorner.y * v);
+        vSphereCenterViewSpace = center;
+        vSphereRadius = aInstanceScale;
+        vFragColor = aInstanceColor;
+        gl_Position = Projection * vec4(vFragPositionViewSpace, 1);
+    }
+);
+
+// Intersection du rayon caméra -> fragment avec la sphère, même éclairage que le maillage
+const GLchar* Renderer3D::IMPOSTOR_FRAGMENT_SHADER =
+"#version 330 core\n"
+CAMERA_UNIFORM_BLOCK_GLSL
+GL_STRINGIFY(
+    in vec3 vFragPositionViewSpace;
+    flat in vec3 vSphereCenterViewSpace;
+    flat in float vSphereRadius;
+    flat in vec3 vFragColor;
 
     out vec3 fFragColor;
 
     void main() {
-        fFragColor = uParticleColor * vec3(abs(dot(normalize(vFragPositionViewSpace), normalize(vFragNormalViewSpace))));
+        vec3 rayDirection = normalize(vFragPositionViewSpace);
+        float b = dot(rayDirection, vSphereCenterViewSpace);
+        float delta = b * b - dot(vSphereCenterViewSpace, vSphereCenterViewSpace) + vSphereRadius * vSphereRadius;
+        if(delta < 0.f)
+            discard;
+
+        vec3 hitViewSpace = (b - sqrt(delta)) * rayDirection;
+        vec3 normalViewSpace = (hitViewSpace - vSphereCenterViewSpace) / vSphereRadius;
+
+        vec4 hitClipSpace = Projection * vec4(hitViewSpace, 1);
+        gl_FragDepth = 0.5f * (hitClipSpace.z / hitClipSpace.w) + 0.5f;
+
+        fFragColor = vFragColor * vec3(abs(dot(rayDirection, normalViewSpace)));
     }
 );
 
 Renderer3D::Renderer3D():
-    m_SphereProgramID(buildProgram(SPHERE_VERTEX_SHADER, SPHERE_FRAGMENT_SHADER)) {
-    // Récuperation des uniforms
-    m_uParticleColor = glGetUniformLocation(m_SphereProgramID, "uParticleColor");
-    m_uMVPMatrix = glGetUniformLocation(m_SphereProgramID, "uMVPMatrix");
-    m_uMVMatrix = glGetUniformLocation(m_SphereProgramID, "uMVMatrix");
+    m_SphereProgramID(buildProgram(SPHERE_VERTEX_SHADER, SPHERE_FRAGMENT_SHADER)),
+    m_ImpostorProgramID(buildProgram(IMPOSTOR_VERTEX_SHADER, IMPOSTOR_FRAGMENT_SHADER)),
+    m_SphereMode(SPHERE_MESH),
+    m_InstancePositionVBO(Graphics::INSTANCE_BUFFER, 2, true, Graphics::DYNAMIC),
+    m_InstanceColorVBO(Graphics::INSTANCE_BUFFER, 3, true, Graphics::DYNAMIC),
+    m_InstanceScaleVBO(Graphics::INSTANCE_FLOAT_BUFFER, 4, true, Graphics::DYNAMIC) {
+    // Matrices lues dans le bloc Camera (Graphics::CameraUniformBuffer)
+    Graphics::CameraUniformBuffer::bindProgram(m_SphereProgramID);
+    Graphics::CameraUniformBuffer::bindProgram(m_ImpostorProgramID);
 
     // Création du VBO
     glGenBuffers(1, &m_SphereVBOID);
@@ -63,40 +140,111 @@ Renderer3D::Renderer3D():
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Sphere::Vertex), (const GLvoid*) offsetof(Sphere::Vertex, position));
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Sphere::Vertex), (const GLvoid*) offsetof(Sphere::Vertex, normal));
 
+    // Attributs d'instance (diviseur 1)
+    m_InstancePositionVBO.init();
+    m_InstanceColorVBO.init();
+    m_InstanceScaleVBO.init();
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    // Impostors: un carré dessiné en triangle strip, mêmes attributs d'instance
+    glGenBuffers(1, &m_ImpostorVBOID);
+    glBindBuffer(GL_ARRAY_BUFFER, m_ImpostorVBOID);
+
+    GLfloat corners[] = {
+        -1.f, -1.f,
+         1.f, -1.f,
+        -1.f,  1.f,
+         1.f,  1.f
+    };
+
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+
+    glGenVertexArrays(1, &m_ImpostorVAOID);
+    glBindVertexArray(m_ImpostorVAOID);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+
+    m_InstancePositionVBO.init();
+    m_InstanceColorVBO.init();
+    m_InstanceScaleVBO.init();
+
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 }
 
 Renderer3D::~Renderer3D() {
     glDeleteProgram(m_SphereProgramID);
+    glDeleteProgram(m_ImpostorProgramID);
 
     glDeleteBuffers(1, &m_SphereVBOID);
     glDeleteVertexArrays(1, &m_SphereVAOID);
+    glDeleteBuffers(1, &m_ImpostorVBOID);
+    glDeleteVertexArrays(1, &m_ImpostorVAOID);
 }
 
 void Renderer3D::clear() {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
+template <typename T>
+void Renderer3D::updateInstanceData(Graphics::VertexBufferObject& vbo, std::vector<T>& uploaded,
+                                    const T* data, uint32_t count) {
+    if(uploaded.size() != count) {
+        uploaded.assign(data, data + count);
+        vbo.updateData(uploaded);
+        return;
+    }
+
+    // Plus petit intervalle contenant tous les éléments modifiés
+    uint32_t first = 0;
+    while(first < count && uploaded[first] == data[first])
+        ++first;
+    if(first == count)
+        return;
+    uint32_t end = count;
+    while(uploaded[end - 1] == data[end - 1])
+        --end;
+
+    std::copy(data + first, data + end, uploaded.begin() + first);
+    vbo.updateSubData(uploaded, first, end - first);
+}
+
 void Renderer3D::drawParticles(uint32_t count,
                    const glm::vec3* positionArray,
                    const float* massArray,
                    const glm::vec3* colorArray,
                    float massScale) {
-    glUseProgram(m_SphereProgramID);
-
-    glBindVertexArray(m_SphereVAOID);
+    if(count == 0)
+        return;
+
+    // Seuls les éléments modifiés depuis la frame précédente sont envoyés
+    // (en général les positions des sphères qui bougent; couleurs et rayons changent rarement)
+    m_NewInstanceScales.resize(count);
+    for(uint32_t i = 0; i < count; ++i)
+        m_NewInstanceScales[i] = massScale * massArray[i];
+
+    updateInstanceData(m_InstancePositionVBO, m_InstancePositions, positionArray, count);
+    updateInstanceData(m_InstanceColorVBO, m_InstanceColors, colorArray, count);
+    updateInstanceData(m_InstanceScaleVBO, m_InstanceScales, m_NewInstanceScales.data(), count);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     glEnable(GL_DEPTH_TEST);
 
-    // Dessine chacune des particules
-    for(uint32_t i = 0; i < count; ++i) {
-        auto modelMatrix = glm::scale(glm::translate(glm::mat4(1.f), positionArray[i]), glm::vec3(massScale * massArray[i]));
-        glUniformMatrix4fv(m_uMVPMatrix, 1, GL_FALSE, glm::value_ptr(m_ProjMatrix * m_ViewMatrix * modelMatrix));
-        glUniformMatrix4fv(m_uMVMatrix, 1, GL_FALSE, glm::value_ptr(m_ViewMatrix * modelMatrix));
+    if(m_SphereMode == SPHERE_IMPOSTOR) {
+        glUseProgram(m_ImpostorProgramID);
+
+        glBindVertexArray(m_ImpostorVAOID);
+
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+    } else {
+        glUseProgram(m_SphereProgramID);
+
+        glBindVertexArray(m_SphereVAOID);
 
-        glUniform3fv(m_uParticleColor, 1, glm::value_ptr(colorArray[i]));
-        glDrawArrays(GL_TRIANGLES, 0, m_nSphereVertexCount);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, m_nSphereVertexCount, count);
     }
 
     glBindVertexArray(0);
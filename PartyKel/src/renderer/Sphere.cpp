@@ -2,6 +2,7 @@
 #include <vector>
 #include <iostream>
 #include "PartyKel/renderer/Sphere.hpp"
+#include "geometry/Frustum.h"
 
 namespace PartyKel {
 
@@ -70,4 +71,26 @@ void Sphere::build(GLfloat r, GLsizei discLat, GLsizei discLong) {
     }
 }
 
+void SphereHandler::getVisibleSpheres(const glm::mat4& MVP, SphereHandler& visibleSpheres) const {
+    visibleSpheres.positions.clear();
+    visibleSpheres.colors.clear();
+    visibleSpheres.radius.clear();
+
+    Geometry::AABBArray bounds;
+    bounds.resize(positions.size());
+    for(size_t i = 0; i < positions.size(); ++i)
+        bounds.set(i, positions[i], radius[i]);
+
+    std::vector<uint32_t> visibilityMask;
+    Geometry::Frustum(MVP).cull(bounds, visibilityMask);
+
+    for(size_t i = 0; i < positions.size(); ++i) {
+        if(Geometry::Frustum::isVisible(visibilityMask, i)) {
+            visibleSpheres.positions.push_back(positions[i]);
+            visibleSpheres.colors.push_back(colors[i]);
+            visibleSpheres.radius.push_back(radius[i]);
+        }
+    }
+}
+
 }
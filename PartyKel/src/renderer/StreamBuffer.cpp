@@ -0,0 +1,138 @@
+#include "PartyKel/renderer/StreamBuffer.hpp"
+
+#include <algorithm>
+
+namespace PartyKel {
+
+// Le buffer est toujours manipulé via GL_COPY_WRITE_BUFFER, qui ne modifie pas l'état du VAO courant
+// (contrairement à GL_ELEMENT_ARRAY_BUFFER): il peut ensuite être lié à n'importe quelle cible
+
+// Alignement des zones: suffisant pour n'importe quel attribut de sommet
+static const GLintptr STREAM_ALIGNMENT = 256;
+
+static GLintptr alignOffset(GLintptr offset) {
+    return (offset + STREAM_ALIGNMENT - 1) / STREAM_ALIGNMENT * STREAM_ALIGNMENT;
+}
+
+StreamBuffer::StreamBuffer(GLsizeiptr size, uint32_t regionCount, bool allowPersistentMapping):
+    m_BufferID(0), m_nCapacity(0),
+    m_bPersistent(allowPersistentMapping && (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)),
+    m_pMappedData(nullptr), m_nHead(0), m_nMappedBegin(0), m_nMappedEnd(0), m_bUnfenced(false) {
+    allocate(regionCount * alignOffset(size));
+}
+
+StreamBuffer::~StreamBuffer() {
+    release();
+}
+
+void StreamBuffer::allocate(GLsizeiptr capacity) {
+    m_nCapacity = capacity;
+    m_nHead = 0;
+
+    glGenBuffers(1, &m_BufferID);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_BufferID);
+
+    if(m_bPersistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, capacity, nullptr, flags);
+        m_pMappedData = static_cast<char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, capacity, flags));
+    } else {
+        glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void StreamBuffer::release() {
+    for(auto& fence : m_Fences)
+        glDeleteSync(fence.sync);
+    m_Fences.clear();
+    m_bUnfenced = false;
+
+    // Le GL attend lui-même la fin des draws utilisant encore le buffer avant de le détruire
+    if(m_pMappedData) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_BufferID);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        m_pMappedData = nullptr;
+    }
+    glDeleteBuffers(1, &m_BufferID);
+    m_BufferID = 0;
+}
+
+void StreamBuffer::waitForRange(GLintptr begin, GLintptr end) {
+    // Les fences sont signalées dans l'ordre: attendre la plus récente qui recouvre la zone suffit
+    size_t count = 0;
+    for(size_t i = 0; i < m_Fences.size(); ++i) {
+        if(m_Fences[i].begin < end && begin < m_Fences[i].end)
+            count = i + 1;
+    }
+
+    if(count == 0)
+        return;
+
+    while(glClientWaitSync(m_Fences[count - 1].sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+
+    for(size_t i = 0; i < count; ++i)
+        glDeleteSync(m_Fences[i].sync);
+    m_Fences.erase(m_Fences.begin(), m_Fences.begin() + count);
+}
+
+void* StreamBuffer::map(GLsizeiptr size) {
+    if(!m_bPersistent) {
+        m_StagingData.resize(size);
+        return m_StagingData.data();
+    }
+
+    fence();
+
+    if(size > m_nCapacity) {
+        // Nouveau buffer: les draws en cours continuent de lire l'ancien
+        release();
+        allocate(std::max(size, 2 * m_nCapacity));
+    }
+
+    GLintptr begin = alignOffset(m_nHead);
+    if(begin + size > m_nCapacity)
+        begin = 0;
+
+    waitForRange(begin, begin + size);
+
+    m_nMappedBegin = begin;
+    m_nMappedEnd = begin + size;
+    m_nHead = m_nMappedEnd;
+
+    return m_pMappedData + begin;
+}
+
+GLintptr StreamBuffer::unmap() {
+    if(m_bPersistent) {
+        // Mapping cohérent: les écritures sont visibles par les commandes émises ensuite
+        m_bUnfenced = true;
+        return m_nMappedBegin;
+    }
+
+    GLsizeiptr size = m_StagingData.size();
+    m_nCapacity = std::max(m_nCapacity, size);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_BufferID);
+    glBufferData(GL_COPY_WRITE_BUFFER, m_nCapacity, nullptr, GL_STREAM_DRAW); // Orphelin: le driver alloue une nouvelle zone
+    glBufferSubData(GL_COPY_WRITE_BUFFER, 0, size, m_StagingData.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    return 0;
+}
+
+void StreamBuffer::fence() {
+    if(!m_bUnfenced)
+        return;
+
+    Fence fence;
+    fence.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    fence.begin = m_nMappedBegin;
+    fence.end = m_nMappedEnd;
+    m_Fences.push_back(fence);
+    m_bUnfenced = false;
+}
+
+}
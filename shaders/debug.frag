@@ -7,10 +7,9 @@ precision highp int;
 layout(location = FRAG_COLOR) out vec4 FragColor;
 
 in vec3 WorldPosition;
-
-uniform vec3 debugColor;
+in vec3 VertexColor;
 
 void main()
 {
-	FragColor = vec4(debugColor, 1);
+	FragColor = vec4(VertexColor, 1);
 }
@@ -2,24 +2,37 @@
 
 #define POSITION	0
 #define INSTANCE_TRANSFORM 1
+#define COLOR 5
 
 precision highp float;
 precision highp int;
 
 layout(location = POSITION) in vec3 Position;
 layout(location = INSTANCE_TRANSFORM) in mat4 InstanceTransform;
-
-in int gl_InstanceID;
+layout(location = COLOR) in vec3 Color;
 
 out vec3 WorldPosition;
+out vec3 VertexColor;
+
+layout(std140) uniform Camera
+{
+	mat4 Projection;
+	mat4 MV;
+	mat4 MVP;
+	mat4 MVNormal;
+	vec4 CamPos;
+	float Time;
+};
 
-uniform mat4 MVP;
+uniform float PointSize = 1.0;
 
 void main()
 {	
 	WorldPosition = (InstanceTransform * vec4(Position,1)).xyz;
+	VertexColor = Color;
 
 	// If there is geometry shader, comment this
 	gl_Position = MVP*vec4(WorldPosition, 1);
+	gl_PointSize = PointSize;
 }
 
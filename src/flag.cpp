@@ -3,16 +3,23 @@
 
 #include <PartyKel/glm.hpp>
 #include <PartyKel/WindowManager.hpp>
-#include <glm/gtc/random.hpp>
 
 #include <PartyKel/renderer/FlagRenderer3D.hpp>
+#include <PartyKel/renderer/GridSubdivider.hpp>
 #include <PartyKel/renderer/TrackballCamera.hpp>
 #include <PartyKel/renderer/Renderer3D.hpp>
 #include <PartyKel/renderer/Sphere.hpp>
 #include <PartyKel/atb.hpp>
 #include <PartyKel/Octree.h>
+#include <PartyKel/Flag.hpp>
+#include <PartyKel/Integrator.hpp>
+#include <PartyKel/AdaptiveTimeStepper.hpp>
+#include <PartyKel/TileSleepController.hpp>
+#include <PartyKel/WindField.hpp>
+#include <graphics/CameraUniformBuffer.h>
 #include <glog/logging.h>
 
+#include <memory>
 #include <vector>
 
 static const Uint32 WINDOW_WIDTH = 1024;
@@ -20,214 +27,6 @@ static const Uint32 WINDOW_HEIGHT = 768;
 
 using namespace PartyKel;
 
-// Calcule une force de type ressort de Hook entre deux particules de positions P1 et P2
-// K est la résistance du ressort et L sa longueur à vide
-inline glm::vec3 hookForce(float K, float L, const glm::vec3& P1, const glm::vec3& P2) {
-    static const float epsilon = 0.0001;
-    return K * (1-(L/std::max(glm::distance(P1, P2), epsilon))) * (P2 - P1);
-}
-
-inline glm::vec3 repulseForce(float dst, const glm::vec3& P1, const glm::vec3& P2) {
-//    return 1.f - glm::normalize(P1 - P2) * dst ;
-    glm::vec3 direction = glm::normalize(P1 - P2);
-    return direction * (1 / (1 + glm::pow(dst, 2.f)));
-}
-
-
-// Calcule une force de type frein cinétique entre deux particules de vélocités v1 et v2
-// V est le paramètre du frein et dt le pas temporel
-inline glm::vec3 brakeForce(float V, float dt, const glm::vec3& v1, const glm::vec3& v2) {
-    return V * ((v2-v1) / dt);
-}
-
-inline glm::vec3 sphereCollisionForce(float distanceToCenter, const glm::vec3& sphereCenter, float sphereRadius, const glm::vec3 particlePosition, const glm::vec3& forceParticle) {
-
-    glm::vec3 direction = glm::normalize(particlePosition - sphereCenter);
-    return direction * (1 / (1 + glm::pow(distanceToCenter, 2.f)));
-}
-
-// Structure permettant de simuler un drapeau à l'aide un système masse-ressort
-struct Flag {
-    int gridWidth, gridHeight; // Dimensions de la grille de points
-
-    // Propriétés physique des points:
-    std::vector<glm::vec3> positionArray;
-    std::vector<glm::vec3> velocityArray;
-    std::vector<float> massArray;
-    std::vector<glm::vec3> forceArray;
-    int nbParticles;
-
-    // Paramètres des forces interne de simulation
-    // Longueurs à vide
-    glm::vec2 L0;
-    float L1;
-    glm::vec2 L2;
-
-    float K0, K1, K2; // Paramètres de résistance
-    float V0, V1, V2; // Paramètres de frein
-
-    // Créé un drapeau discretisé sous la forme d'une grille contenant gridWidth * gridHeight
-    // points. Chaque point a pour masse mass / (gridWidth * gridHeight).
-    // La taille du drapeau en 3D est spécifié par les paramètres width et height
-    Flag(float mass, float width, float height, int gridWidth, int gridHeight):
-            gridWidth(gridWidth), gridHeight(gridHeight),
-            positionArray(gridWidth * gridHeight),
-            velocityArray(gridWidth * gridHeight, glm::vec3(0.f)),
-            massArray(gridWidth * gridHeight, mass / (gridWidth * gridHeight)),
-            forceArray(gridWidth * gridHeight, glm::vec3(0.f)) {
-
-
-        glm::vec3 origin(-0.5f * width, -0.5f * height, 0.f);
-        glm::vec3 scale(width / (gridWidth - 1), height / (gridHeight - 1), 1.f);
-
-        nbParticles = gridWidth * gridHeight;
-        for(int j = 0; j < gridHeight; ++j) {
-            for(int i = 0; i < gridWidth; ++i) {
-                int k = i + j * gridWidth;
-                positionArray[k] = origin + glm::vec3(i, j, origin.z) * scale;
-                massArray[k] = 1 - ( i / (2*(gridHeight*gridWidth)));
-            }
-        }
-
-        // Les longueurs à vide sont calculés à partir de la position initiale
-        // des points sur le drapeau
-        L0.x = scale.x;
-        L0.y = scale.y;
-        L1 = glm::length(L0);
-        L2 = 2.f * L0;
-
-        // Ces paramètres sont à fixer pour avoir un système stable: HAVE FUN !
-        K0 = 1;
-        K1 = 1;
-        K2 = 1;
-
-        V0 = 0.08;
-        V1 = 0.02;
-        V2 = 0.06;
-    }
-
-    // Applique les forces internes sur chaque point du drapeau SAUF les points fixes
-    void applyInternalForces(float dt) {
-        std::vector<glm::ivec2> neighbors(4);
-        for(int i = 0; i<gridWidth; ++i){
-            for(int j = 1; j<gridHeight; ++j){
-                int currentK = j*gridWidth + i;
-//                if(currentK == nbParticles-1 || currentK == nbParticles - gridWidth)
-//                    continue;
-
-                // TOPOLOGY 1
-                neighbors[0] = glm::ivec2(i+1, j);
-                neighbors[1] = glm::ivec2(i-1, j);
-                neighbors[2] = glm::ivec2(i, j-1);
-                neighbors[3] = glm::ivec2(i, j+1);
-
-                int tmpI = 0;
-                for(auto& p : neighbors){
-                    if(p.x < 0 || p.y < 0 || p.x >= gridWidth || p.y >= gridHeight)
-                        continue;
-                    int k = p.y * gridWidth + p.x;
-                    forceArray[currentK] += hookForce(K0, tmpI < 2 ? L0.x : L0.y, positionArray[currentK], positionArray[k]);
-                    forceArray[currentK] += brakeForce(V0, dt, velocityArray[currentK], velocityArray[k]);
-                    ++tmpI;
-                }
-
-                // TOPOLOGY 2
-                neighbors[0] = glm::ivec2(i-1, j-1);
-                neighbors[1] = glm::ivec2(i+1, j-1);
-                neighbors[2] = glm::ivec2(i+1, j+1);
-                neighbors[3] = glm::ivec2(i-1, j+1);
-
-                for(auto& p : neighbors){
-                    if(p.x < 0 || p.y < 0 || p.x >= gridWidth || p.y >= gridHeight)
-                        continue;
-                    int k = p.y * gridWidth + p.x;
-                    forceArray[currentK] += hookForce(K1, L1, positionArray[currentK], positionArray[k]);
-                    forceArray[currentK] += brakeForce(V1, dt, velocityArray[currentK], velocityArray[k]);
-                }
-
-                // TOPOLOGY 3
-                neighbors[0] = glm::ivec2(i-2, j);
-                neighbors[1] = glm::ivec2(i+2, j);
-                neighbors[2] = glm::ivec2(i, j-2);
-                neighbors[3] = glm::ivec2(i, j+2);
-
-                tmpI = 0;
-                for(auto& p : neighbors){
-                    if(p.x < 0 || p.y < 0 || p.x >= gridWidth || p.y >= gridHeight)
-                        continue;
-                    int k = p.y * gridWidth + p.x;
-                    forceArray[currentK] += hookForce(K2, tmpI < 2 ? L2.x : L2.y, positionArray[currentK], positionArray[k]);
-                    forceArray[currentK] += brakeForce(V2, dt, velocityArray[currentK], velocityArray[k]);
-                    ++tmpI;
-                }
-
-            }
-        }
-    }
-
-    void applyRepulseForces(Octree<glm::vec3>& octree, float maxDst, float multRepulse){
-        for(int i = 0; i<gridWidth; ++i) {
-            for (int j = 1; j < gridHeight; ++j) {
-                int k = j*gridWidth + i;
-                auto& pos = positionArray[k];
-
-                auto &inSameVoxel = octree.get(pos);
-                assert(!inSameVoxel.empty());
-
-                if (inSameVoxel.size() < 2)
-                    continue;
-
-                for (auto &v : inSameVoxel) {
-                    float dst = glm::distance(v, pos);
-                    if (dst > maxDst || pos == v)
-                        continue;
-
-                    forceArray[k] += repulseForce(dst, pos, v) * multRepulse;
-                }
-            }
-        }
-    }
-
-
-    // Applique une force externe sur chaque point du drapeau SAUF les points fixes
-    void applyExternalForce(const glm::vec3& F) {
-
-        for(int i = 0; i < nbParticles; ++i){
-//            if( (i%gridWidth) == 0)
-//                continue;
-            if(i<gridWidth)
-                continue;
-            forceArray[i] += F;
-        }
-
-    }
-
-    void applySphereCollision(const SphereHandler& sphereHandler, float multiplier, float radiusDelta) {
-
-        for(int i = 0; i < nbParticles; ++i){
-            if( (i%gridWidth) == 0)
-                continue;
-
-            for(size_t j = 0; j < sphereHandler.positions.size(); ++j){
-                float dist = glm::distance(sphereHandler.positions[j], positionArray[i]);
-                if(dist < sphereHandler.radius[j] + radiusDelta){
-                    forceArray[i] += sphereCollisionForce(dist, sphereHandler.positions[j], sphereHandler.radius[j], positionArray[i], forceArray[i]) * multiplier;
-                }
-            }
-        }
-    }
-
-    // Met à jour la vitesse et la position de chaque point du drapeau
-    // en utilisant un schema de type Leapfrog
-    void update(float dt) {
-        for(int i = 0; i<nbParticles ; ++i){
-            velocityArray[i] += dt * (forceArray[i]/massArray[i]);
-            positionArray[i] += dt * velocityArray[i];
-            forceArray[i] = glm::vec3(0);
-        }
-    }
-};
-
 int main() {
 
     SphereHandler sphereHandler;
@@ -254,13 +53,15 @@ int main() {
     bool displayOctree          = false;
     bool activeSpheres          = false;
     bool activeAutoCollisions   = false;
+    bool gpuNormals             = true; // N'envoie que les positions, les normales sont calculées dans le vertex shader
+    bool frustumCulling         = true; // Ne dessine que les carrés du drapeau et les sphères dans le champ de la caméra
+    bool packedVertices         = false; // Sommets compressés (positions 16 bits, normales octaédriques) quand les normales sont calculées sur le CPU
 
     FlagRenderer3D renderer(flag.gridWidth, flag.gridHeight);
     Octree<glm::vec3> octree(7, glm::vec3(0,-10,0), glm::vec3(50.f));
 
     glm::mat4 projection = glm::perspective(70.f, float(WINDOW_WIDTH) / WINDOW_HEIGHT, 0.1f, 100.f);
-
-    renderer.setProjMatrix(projection);
+    Graphics::CameraUniformBuffer cameraUBO; // Matrices partagées par tous les programmes
     TwBar* gui = TwNewBar("Parametres");
 
     float randomMoveScale = 0.01f;
@@ -288,6 +89,79 @@ int main() {
     atb::addVarRW(gui, ATB_VAR(displayOctree));
     atb::addVarRW(gui, ATB_VAR(activeAutoCollisions));
     atb::addVarRW(gui, ATB_VAR(activeSpheres));
+    atb::addVarRW(gui, ATB_VAR(gpuNormals));
+    atb::addVarRW(gui, ATB_VAR(frustumCulling));
+    atb::addVarRW(gui, ATB_VAR(packedVertices));
+
+    // Rendu d'une surface lisse renderSubdivision fois plus fine que la grille simulée (GridSubdivider),
+    // la simulation garde la résolution de flagGrid. 1: rendu direct de la grille simulée
+    int renderSubdivision = 1;
+    std::unique_ptr<GridSubdivider> subdivider;
+    std::unique_ptr<FlagRenderer3D> smoothRenderer;
+    atb::addVarRWCB(gui, ATB_VAR(renderSubdivision), [&]() {
+        subdivider.reset();
+        smoothRenderer.reset();
+        if(renderSubdivision > 1) {
+            int fineWidth = (flag.gridWidth - 1) * renderSubdivision + 1;
+            int fineHeight = (flag.gridHeight - 1) * renderSubdivision + 1;
+            subdivider.reset(new GridSubdivider(flag.gridWidth, flag.gridHeight, fineWidth, fineHeight));
+            smoothRenderer.reset(new FlagRenderer3D(fineWidth, fineHeight));
+        }
+    }, "min=1 max=8");
+
+    // Schémas d'intégration disponibles, dans l'ordre de l'enum de la GUI
+    SymplecticEulerIntegrator<glm::vec3> symplecticEuler;
+    VelocityVerletIntegrator<glm::vec3> velocityVerlet;
+    PositionVerletIntegrator<glm::vec3> positionVerlet;
+    RK4Integrator<glm::vec3> rk4;
+    std::vector<AbstractIntegrator<glm::vec3>*> integrators = {&symplecticEuler, &velocityVerlet, &positionVerlet, &rk4};
+    int integrator = 0;
+
+    atb::addVarRWCB(gui, "integrator", "SymplecticEuler,VelocityVerlet,PositionVerlet,RK4", integrator, [&]() {
+        integrators[integrator]->reset();
+    });
+    atb::addVarROCB(gui, "forceEvaluations", [&]() -> uint32_t {
+        return integrators[integrator]->getLastStepForceEvaluations();
+    });
+
+    // Sous-découpage du pas de la frame selon la stabilité estimée du drapeau
+    AdaptiveTimeStepper timeStepper;
+    atb::addVarRW(gui, "safetyFactor", timeStepper.safetyFactor(), "step=0.01");
+    atb::addVarRW(gui, "maxDisplacement", timeStepper.maxDisplacement(), "step=0.01");
+    atb::addVarROCB(gui, "subSteps", [&]() -> uint32_t {
+        return timeStepper.getLastSubStepCount();
+    });
+
+    // Vent: flux moyen + turbulence qui défile avec le temps
+    WindField windField;
+    float time = 0.f;
+    atb::addVarRW(gui, "windX", windField.meanFlow().x, "step=0.01");
+    atb::addVarRW(gui, "windY", windField.meanFlow().y, "step=0.01");
+    atb::addVarRW(gui, "windZ", windField.meanFlow().z, "step=0.01");
+    atb::addVarRW(gui, "turbulence", windField.turbulence(), "step=0.01");
+
+    // Uniform: le vent est une force appliquée à chaque point
+    // Aerodynamic: le vent est la vitesse de l'air (windField * windSpeed), qui exerce une pression sur les triangles
+    int windModel = 1;
+    float windSpeed = 40.f;
+    atb::addVarRW(gui, "windModel", "Uniform,Aerodynamic", windModel);
+    atb::addVarRW(gui, ATB_VAR(windSpeed), "step=0.1");
+    atb::addVarRW(gui, ATB_VAR(flag.Cd), "step=0.01");
+    atb::addVarRW(gui, ATB_VAR(flag.Cl), "step=0.01");
+
+    // Endormissement des zones immobiles du drapeau
+    TileSleepController sleepController;
+    bool activeSleeping = false;
+    atb::addVarRWCB(gui, "activeSleeping", activeSleeping, [&]() {
+        if(!activeSleeping)
+            sleepController.wakeAll(flag);
+    });
+    atb::addVarRW(gui, "sleepEnergy", sleepController.energyThreshold(), "step=0.00001");
+    atb::addVarRW(gui, "sleepForce", sleepController.forceThreshold(), "step=0.001");
+    atb::addVarRW(gui, "sleepWindChange", sleepController.externalForceThreshold(), "step=0.001");
+    atb::addVarROCB(gui, "sleepingTiles", [&]() -> uint32_t {
+        return sleepController.getSleepingTileCount();
+    });
 
 
     atb::addButton(gui, "reset", [&]() {
@@ -298,7 +172,12 @@ int main() {
         tmp.V0 = flag.V0;
         tmp.V1 = flag.V1;
         tmp.V2 = flag.V2;
+        tmp.Cd = flag.Cd;
+        tmp.Cl = flag.Cl;
         flag = tmp;
+        integrators[integrator]->reset();
+        timeStepper.reset();
+        sleepController.reset();
     });
 
     TrackballCamera camera;
@@ -309,11 +188,14 @@ int main() {
     float dt = 0.f;
 
     Graphics::ShaderProgram debugProgram("../shaders/debug.vert", "", "../shaders/debug.frag");
+    Graphics::CameraUniformBuffer::bindProgram(debugProgram);
     Renderer3D renderer3D;
-    renderer3D.setProjMatrix(projection);
 
     FLAGS_minloglevel = 1;
 
+    std::vector<uint8_t> visiblePatches;
+    SphereHandler visibleSpheres;
+
     bool done = false;
     bool wireframe = true;
     while(!done) {
@@ -321,43 +203,98 @@ int main() {
 
         // Rendu
         renderer.clear();
-        renderer.setViewMatrix(camera.getViewMatrix());
-        renderer3D.setViewMatrix(camera.getViewMatrix());
-        renderer.drawGrid(flag.positionArray.data(), wireframe);
-
-        debugProgram.updateUniform("MVP", projection * camera.getViewMatrix());
+        cameraUBO.update(projection, camera.getViewMatrix(), time);
+
+        // Les collisions utilisent toujours toutes les sphères, seul l'affichage est limité au champ de la caméra
+        glm::mat4 MVP = projection * camera.getViewMatrix();
+        if(frustumCulling)
+            flag.computeVisiblePatches(MVP, visiblePatches);
+        else
+            visiblePatches.clear();
+        renderer.setVisiblePatches(visiblePatches);
+        renderer.setVertexFormat(packedVertices ? PACKED_VERTICES : FLOAT_VERTICES);
+
+        if(subdivider) {
+            // Les carrés visibles sont ceux de la grille simulée: la surface fine est dessinée entière
+            const glm::vec3* finePositionArray = subdivider->subdivide(flag.positionArray.data());
+            if(gpuNormals)
+                smoothRenderer->drawGridGPUNormals(finePositionArray, wireframe);
+            else {
+                smoothRenderer->setVertexFormat(packedVertices ? PACKED_VERTICES : FLOAT_VERTICES);
+                smoothRenderer->drawGrid(finePositionArray, wireframe);
+            }
+        } else if(gpuNormals)
+            renderer.drawGridGPUNormals(flag.positionArray.data(), wireframe);
+        else {
+            glm::vec3 AABBmin, AABBmax; // Boîte tenue à jour par la simulation, référence des sommets compressés
+            flag.getAABB(AABBmin, AABBmax);
+            if(windModel == 0)
+                renderer.drawGrid(flag.positionArray.data(), AABBmin, AABBmax, wireframe);
+            else
+                renderer.drawGrid(flag.positionArray.data(), flag.triangleNormalArray.data(), AABBmin, AABBmax, wireframe); // Normales de la dernière évaluation des forces
+        }
 
-        if(activeSpheres)
-            renderer3D.drawParticles(sphereHandler.positions.size(), sphereHandler.positions.data(), sphereHandler.radius.data(), sphereHandler.colors.data(), 1);
+        if(activeSpheres) {
+            const SphereHandler* pSpheres = &sphereHandler;
+            if(frustumCulling) {
+                sphereHandler.getVisibleSpheres(MVP, visibleSpheres);
+                pSpheres = &visibleSpheres;
+            }
+            if(!pSpheres->positions.empty())
+                renderer3D.drawParticles(pSpheres->positions.size(), pSpheres->positions.data(), pSpheres->radius.data(), pSpheres->colors.data(), 1);
+        }
 
         // Simulation
         if(dt > 0.f) {
-            flag.applyExternalForce(G); // Applique la gravité
-            flag.applyExternalForce(glm::sphericalRand(0.05f)); // Applique un "vent" de direction aléatoire et de force 0.1 Newtons
-            flag.applyInternalForces(dt); // Applique les forces internes
+            // Les perturbations réveillent les tuiles endormies avant la simulation.
+            // NB: seul un changement du flux moyen réveille le drapeau entier, une turbulence forte
+            // l'empêche simplement de s'endormir
+            if(activeSleeping) {
+                sleepController.notifyExternalForce(flag, windField.meanFlow());
+                if(activeSpheres) {
+                    for(size_t i = 0; i < sphereHandler.positions.size(); ++i)
+                        sleepController.wakeInSphere(flag, sphereHandler.positions[i], sphereHandler.radius[i] + radiusDelta);
+                }
+            }
 
-            if(activeSpheres)
-                flag.applySphereCollision(sphereHandler, sphereCollisionMultiplier, radiusDelta);
+            timeStepper.advance(flag, *integrators[integrator], dt, dt, [&]() {
+                flag.applyExternalForce(G); // Applique la gravité
+                if(windModel == 0)
+                    flag.applyWindField(windField, time);
+                else
+                    flag.applyAerodynamicForces(windField, time, windSpeed);
+                flag.applyInternalForces(dt); // Applique les forces internes
 
-            for(auto& pos : flag.positionArray)
-                octree.add(pos, pos);
+                if(activeSpheres)
+                    flag.applySphereCollision(sphereHandler, sphereCollisionMultiplier, radiusDelta);
 
-            if(activeAutoCollisions)
-                flag.applyRepulseForces(octree, maxDstRepulseForce, multRepulseForce);
+                if(activeAutoCollisions) {
+                    for(auto& pos : flag.positionArray)
+                        octree.add(pos, pos);
 
+                    flag.applyRepulseForces(octree, maxDstRepulseForce, multRepulseForce);
+
+                    for(auto& pos : flag.positionArray)
+                        octree.remove(pos, pos);
+                }
+            });
+
+            if(activeSleeping)
+                sleepController.update(flag);
+
+            time += dt;
 
             if(displayOctree){
-                octree.draw(debugProgram);
-                octree.drawRecursive(debugProgram);
-                glBindVertexArray(0);
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-                glBindBuffer(GL_ARRAY_BUFFER, 0);
-            }
+                for(auto& pos : flag.positionArray)
+                    octree.add(pos, pos);
 
-            for(auto& pos : flag.positionArray)
-                octree.remove(pos, pos);
+                octree.draw();
+                octree.drawRecursive();
+                Graphics::DebugDrawer::flush(debugProgram);
 
-            flag.update(dt); // Mise à jour du système à partir des forces appliquées
+                for(auto& pos : flag.positionArray)
+                    octree.remove(pos, pos);
+            }
         }
 
 
@@ -0,0 +1,154 @@
+#include <iostream>
+#include <cstdlib>
+
+#include <PartyKel/glm.hpp>
+#include <PartyKel/WindowManager.hpp>
+
+#include <PartyKel/renderer/FlagBatchRenderer3D.hpp>
+#include <PartyKel/renderer/TrackballCamera.hpp>
+#include <PartyKel/Flag.hpp>
+#include <PartyKel/FlagLOD.hpp>
+#include <PartyKel/Integrator.hpp>
+#include <PartyKel/WindField.hpp>
+#include <graphics/CameraUniformBuffer.h>
+#include <geometry/Frustum.h>
+
+#include <vector>
+
+static const Uint32 WINDOW_WIDTH = 1024;
+static const Uint32 WINDOW_HEIGHT = 768;
+
+// Champ de drapeaux: FLAG_COUNT.x * FLAG_COUNT.y drapeaux dessinés en un seul appel (FlagBatchRenderer3D)
+static const glm::ivec2 FLAG_COUNT(8, 8);
+static const glm::ivec2 FLAG_GRID(20, 10);
+static const glm::vec2 FLAG_SIZE(2, 1);
+static const glm::vec2 FLAG_SPACING(3, 2);
+
+using namespace PartyKel;
+
+int main() {
+    WindowManager wm(WINDOW_WIDTH, WINDOW_HEIGHT, "Newton was a Geek");
+    wm.setFramerate(30);
+
+    glm::vec3 G(0.f, -0.08f, 0.f); // Gravité
+    WindField windField;
+    float time = 0.f;
+
+    // Chaque drapeau est simulé à une résolution qui dépend de sa distance à la caméra (FlagLOD),
+    // et toujours dessiné à la résolution FLAG_GRID
+    FlagBatchRenderer3D renderer;
+    std::vector<FlagLOD> flags;
+    for(int y = 0; y < FLAG_COUNT.y; ++y) {
+        for(int x = 0; x < FLAG_COUNT.x; ++x) {
+            FlagLOD lod(4096.f, FLAG_SIZE.x, FLAG_SIZE.y, FLAG_GRID.x, FLAG_GRID.y);
+            glm::vec3 offset((x - 0.5f * (FLAG_COUNT.x - 1)) * FLAG_SPACING.x, (y - 0.5f * (FLAG_COUNT.y - 1)) * FLAG_SPACING.y, 0.f);
+            Flag& flag = lod.getFlag();
+            for(auto& position : flag.positionArray)
+                position += offset;
+            flag.updatePatchBounds();
+            flags.push_back(lod);
+            renderer.addFlag(FLAG_GRID.x, FLAG_GRID.y);
+        }
+    }
+
+    std::vector<const glm::vec3*> positionArrays(flags.size());
+    std::vector<uint8_t> visibleFlags(flags.size());
+    Geometry::AABBArray flagBounds;
+    flagBounds.resize(flags.size());
+    std::vector<uint32_t> visibilityMask;
+    bool frustumCulling = true; // Seuls les drapeaux dans le champ de la caméra sont envoyés et dessinés
+    SymplecticEulerIntegrator<glm::vec3> integrator;
+
+    glm::mat4 projection = glm::perspective(70.f, float(WINDOW_WIDTH) / WINDOW_HEIGHT, 0.1f, 100.f);
+    Graphics::CameraUniformBuffer cameraUBO;
+
+    TrackballCamera camera;
+    camera.moveFront(20);
+    int mouseLastX, mouseLastY;
+
+    // Temps s'écoulant entre chaque frame
+    float dt = 0.f;
+
+    bool done = false;
+    bool wireframe = false;
+    while(!done) {
+        wm.startMainLoop();
+
+        // Rendu
+        renderer.clear();
+        cameraUBO.update(projection, camera.getViewMatrix(), time);
+        for(size_t i = 0; i < flags.size(); ++i) {
+            glm::vec3 AABBmin, AABBmax;
+            flags[i].getFlag().getAABB(AABBmin, AABBmax);
+            flagBounds.set(i, AABBmin, AABBmax);
+        }
+        Geometry::Frustum(projection * camera.getViewMatrix()).cull(flagBounds, visibilityMask);
+        for(size_t i = 0; i < flags.size(); ++i) {
+            visibleFlags[i] = Geometry::Frustum::isVisible(visibilityMask, i);
+            // Les drapeaux cachés ne sont pas envoyés: inutile d'évaluer leur surface
+            positionArrays[i] = visibleFlags[i] || !frustumCulling ? flags[i].getFullResolutionPositions() : nullptr;
+        }
+        renderer.drawFlags(positionArrays, wireframe, frustumCulling ? visibleFlags : std::vector<uint8_t>());
+
+        // Simulation
+        if(dt > 0.f) {
+            glm::vec3 cameraPosition = camera.getPosition();
+            for(auto& lod : flags) {
+                lod.update(cameraPosition);
+                Flag& flag = lod.getFlag();
+                float pointScale = lod.getPointScale(); // Les forces par point suivent la masse des points du niveau
+                flag.update(integrator, dt, [&]() {
+                    flag.applyExternalForce(G * pointScale); // Applique la gravité
+                    flag.applyWindField(windField, time, pointScale);
+                    flag.applyInternalForces(dt); // Applique les forces internes
+                });
+            }
+            time += dt;
+        }
+
+        // Gestion des evenements
+        SDL_Event e;
+        while(wm.pollEvent(e)) {
+            switch(e.type) {
+                default:
+                    break;
+                case SDL_QUIT:
+                    done = true;
+                    break;
+                case SDL_KEYDOWN:
+                    if(e.key.keysym.sym == SDLK_SPACE) {
+                        wireframe = !wireframe;
+                    } else if(e.key.keysym.sym == SDLK_p) {
+                        // Sommets compressés (positions 16 bits, normales octaédriques)
+                        renderer.setVertexFormat(renderer.getVertexFormat() == FLOAT_VERTICES ? PACKED_VERTICES : FLOAT_VERTICES);
+                    } else if(e.key.keysym.sym == SDLK_c) {
+                        frustumCulling = !frustumCulling;
+                    }
+                    break;
+                case SDL_MOUSEBUTTONDOWN:
+                    if(e.button.button == SDL_BUTTON_WHEELUP) {
+                        camera.moveFront(0.1f);
+                    } else if(e.button.button == SDL_BUTTON_WHEELDOWN) {
+                        camera.moveFront(-0.1f);
+                    } else if(e.button.button == SDL_BUTTON_LEFT) {
+                        mouseLastX = e.button.x;
+                        mouseLastY = e.button.y;
+                    }
+            }
+        }
+
+        int mouseX, mouseY;
+        if(SDL_GetMouseState(&mouseX, &mouseY) & SDL_BUTTON(SDL_BUTTON_LEFT)) {
+            float dX = mouseX - mouseLastX, dY = mouseY - mouseLastY;
+            camera.rotateLeft(glm::radians(dX));
+            camera.rotateUp(glm::radians(dY));
+            mouseLastX = mouseX;
+            mouseLastY = mouseY;
+        }
+
+        // Mise à jour de la fenêtre
+        dt = wm.update();
+    }
+
+    return EXIT_SUCCESS;
+}
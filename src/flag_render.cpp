@@ -0,0 +1,94 @@
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include <PartyKel/glm.hpp>
+#include <PartyKel/OffscreenContext.hpp>
+
+#include <PartyKel/renderer/FlagRenderer3D.hpp>
+#include <PartyKel/renderer/FramebufferTarget.hpp>
+#include <PartyKel/renderer/FrameCapture.hpp>
+#include <PartyKel/renderer/TrackballCamera.hpp>
+#include <PartyKel/Flag.hpp>
+#include <PartyKel/Integrator.hpp>
+#include <PartyKel/AdaptiveTimeStepper.hpp>
+#include <PartyKel/WindField.hpp>
+#include <graphics/CameraUniformBuffer.h>
+
+static const GLsizei IMAGE_WIDTH = 1024;
+static const GLsizei IMAGE_HEIGHT = 768;
+
+// Pas de temps d'une image, en unités de la simulation (celui de WindowManager::update à 30 images par seconde)
+static const float FRAME_DT = 0.01f * 1000.f / 30.f;
+
+using namespace PartyKel;
+
+// La simulation avance d'un pas fixe par image, aussi vite que le permettent le calcul et le rendu
+static void renderAnimation(uint32_t frameCount, const std::string& filePattern) {
+    OffscreenContext context;
+    FramebufferTarget target(IMAGE_WIDTH, IMAGE_HEIGHT);
+    FrameCapture frameCapture(IMAGE_WIDTH, IMAGE_HEIGHT, filePattern);
+
+    Flag flag(4096.f, 5, 2, 100, 20); // Création d'un drapeau
+    glm::vec3 G(0.f, -0.08, 0.f); // Gravité
+    WindField windField;
+    float windSpeed = 40.f;
+    float time = 0.f;
+
+    SymplecticEulerIntegrator<glm::vec3> integrator;
+    AdaptiveTimeStepper timeStepper;
+
+    FlagRenderer3D renderer(flag.gridWidth, flag.gridHeight);
+    glm::mat4 projection = glm::perspective(70.f, float(IMAGE_WIDTH) / IMAGE_HEIGHT, 0.1f, 100.f);
+    Graphics::CameraUniformBuffer cameraUBO;
+
+    TrackballCamera camera;
+    camera.moveFront(20);
+
+    auto startTime = std::chrono::steady_clock::now();
+    uint32_t maxPendingFrames = 0;
+
+    target.bind();
+    for(uint32_t frame = 0; frame < frameCount; ++frame) {
+        // Rendu
+        renderer.clear();
+        cameraUBO.update(projection, camera.getViewMatrix(), time);
+        renderer.drawGridGPUNormals(flag.positionArray.data(), false);
+        frameCapture.capture();
+        maxPendingFrames = std::max(maxPendingFrames, frameCapture.getPendingFrameCount());
+
+        // Simulation
+        timeStepper.advance(flag, integrator, FRAME_DT, FRAME_DT, [&]() {
+            flag.applyExternalForce(G); // Applique la gravité
+            flag.applyAerodynamicForces(windField, time, windSpeed);
+            flag.applyInternalForces(FRAME_DT); // Applique les forces internes
+        });
+        time += FRAME_DT;
+    }
+    frameCapture.finish();
+
+    float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << frameCapture.getCapturedFrameCount() << " frames in " << seconds << " s ("
+              << frameCapture.getCapturedFrameCount() / seconds << " fps), at most "
+              << maxPendingFrames << " frames waiting to be written" << std::endl;
+}
+
+// Rendu sans fenêtre d'une animation du drapeau en suite d'images PPM:
+// flag_render [nombre d'images] [chemin printf des images, par exemple "frames/flag_%05d.ppm"]
+int main(int argc, char** argv) {
+    uint32_t frameCount = argc > 1 ? std::atoi(argv[1]) : 300;
+    std::string filePattern = argc > 2 ? argv[2] : "flag_%05d.ppm";
+
+    // Contexte EGL indisponible (PartyKel compilé sans EGL), framebuffer incomplet ou motif de fichier invalide
+    try {
+        renderAnimation(frameCount, filePattern);
+    } catch(const std::exception& e) {
+        std::cerr << "flag_render: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
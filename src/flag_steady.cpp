@@ -6,6 +6,7 @@
 
 #include <PartyKel/renderer/FlagRenderer3D.hpp>
 #include <PartyKel/renderer/TrackballCamera.hpp>
+#include <graphics/CameraUniformBuffer.h>
 
 #include <vector>
 
@@ -107,7 +108,8 @@ int main() {
     glm::vec3 G(0.f, -0.001f, 0.f); // Gravité
 
     FlagRenderer3D renderer(flag.gridWidth, flag.gridHeight);
-    renderer.setProjMatrix(glm::perspective(70.f, float(WINDOW_WIDTH) / WINDOW_HEIGHT, 0.1f, 100.f));
+    glm::mat4 projection = glm::perspective(70.f, float(WINDOW_WIDTH) / WINDOW_HEIGHT, 0.1f, 100.f);
+    Graphics::CameraUniformBuffer cameraUBO;
 
     TrackballCamera camera;
     int mouseLastX, mouseLastY;
@@ -123,7 +125,7 @@ int main() {
         // Rendu
         renderer.clear();
 
-        renderer.setViewMatrix(camera.getViewMatrix());
+        cameraUBO.update(projection, camera.getViewMatrix());
         renderer.drawGrid(flag.positionArray.data(), wireframe);
 
         // Simulation
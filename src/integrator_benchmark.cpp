@@ -0,0 +1,97 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+
+#include <PartyKel/glm.hpp>
+#include <PartyKel/Flag.hpp>
+#include <PartyKel/Integrator.hpp>
+
+#include <vector>
+
+using namespace PartyKel;
+
+// Compare les schémas d'intégration sur la scène du drapeau: pour chaque intégrateur et chaque pas
+// de temps, mesure le temps de calcul et l'erreur (RMS sur les positions) par rapport à une solution
+// de référence RK4 à très petit pas.
+//
+// La sortie est au format gnuplot, un bloc par intégrateur:
+//   ./integrator_benchmark > bench.dat
+//   gnuplot -e "set logscale xy; set xlabel 'wall time (ms)'; set ylabel 'RMS error';
+//               plot for [i=0:3] 'bench.dat' index i using 4:5 with linespoints title columnheader(1)" -p
+
+static const glm::ivec2 FLAG_GRID(50, 20);
+static const glm::vec2 FLAG_SIZE(5, 2);
+static const float DURATION = 10.f;
+static const float REFERENCE_DT = 0.005f;
+
+// Le frein du drapeau divise par dt: on le fixe au pas d'une frame pour que tous les
+// intégrateurs résolvent la même équation quel que soit leur pas de temps.
+static const float BRAKE_DT = 0.33f;
+
+static void simulate(Flag& flag, AbstractIntegrator<glm::vec3>& integrator, float dt, float duration) {
+    const glm::vec3 G(0.f, -0.08f, 0.f);
+    const glm::vec3 wind(0.02f, 0.f, 0.03f);
+
+    auto computeForces = [&]() {
+        flag.applyExternalForce(G);
+        flag.applyExternalForce(wind);
+        flag.applyInternalForces(BRAKE_DT);
+    };
+
+    int stepCount = int(std::lround(duration / dt));
+    for(int i = 0; i < stepCount; ++i)
+        flag.update(integrator, dt, computeForces);
+}
+
+static float rmsError(const Flag& flag, const Flag& reference) {
+    double sum = 0.;
+    for(int i = 0; i < flag.nbParticles; ++i) {
+        float d = glm::distance(flag.positionArray[i], reference.positionArray[i]);
+        sum += d * d;
+    }
+    return std::sqrt(sum / flag.nbParticles);
+}
+
+int main() {
+    Flag reference(4096.f, FLAG_SIZE.x, FLAG_SIZE.y, FLAG_GRID.x, FLAG_GRID.y);
+    RK4Integrator<glm::vec3> referenceIntegrator;
+    simulate(reference, referenceIntegrator, REFERENCE_DT, DURATION);
+
+    SymplecticEulerIntegrator<glm::vec3> symplecticEuler;
+    VelocityVerletIntegrator<glm::vec3> velocityVerlet;
+    PositionVerletIntegrator<glm::vec3> positionVerlet;
+    RK4Integrator<glm::vec3> rk4;
+    std::vector<AbstractIntegrator<glm::vec3>*> integrators = {&symplecticEuler, &velocityVerlet, &positionVerlet, &rk4};
+
+    // Les pas divisent tous DURATION pour comparer les états au même instant
+    std::vector<float> timeSteps = {0.5f, 0.4f, 0.25f, 0.2f, 0.1f, 0.05f, 0.025f};
+
+    for(auto integrator : integrators) {
+        std::cout << integrator->getName() << std::endl;
+        std::cout << "# dt evaluations/step evaluations wall_ms rms_error" << std::endl;
+
+        for(float dt : timeSteps) {
+            Flag flag(4096.f, FLAG_SIZE.x, FLAG_SIZE.y, FLAG_GRID.x, FLAG_GRID.y);
+            integrator->reset();
+            uint64_t evaluations = integrator->getTotalForceEvaluations();
+
+            auto start = std::chrono::high_resolution_clock::now();
+            simulate(flag, *integrator, dt, DURATION);
+            auto end = std::chrono::high_resolution_clock::now();
+
+            float wallTime = std::chrono::duration<float, std::milli>(end - start).count();
+            evaluations = integrator->getTotalForceEvaluations() - evaluations;
+
+            std::cout << dt << " "
+                      << integrator->getForceEvaluationsPerStep() << " "
+                      << evaluations << " "
+                      << wallTime << " "
+                      << rmsError(flag, reference) << std::endl;
+        }
+
+        std::cout << std::endl << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -7,7 +7,8 @@
 #include <PartyKel/atb.hpp>
 #include <PartyKel/ParticleManager2D.hpp>
 #include <PartyKel/ConstantForce2D.hpp>
-#include <PartyKel/LeapfrogSolver2D.hpp>
+#include <PartyKel/Solver2D.hpp>
+#include <PartyKel/Integrator.hpp>
 
 #include <vector>
 
@@ -32,7 +33,9 @@ int main() {
     // Création des particules
     ParticleManager2D particleManager;
     ConstantForce2D constantForce2D(glm::vec2(0, -0.01));
-    LeapfrogSolver2D leapfrogSolver2D;
+    SymplecticEulerIntegrator<glm::vec2> integrator;
+    Solver2D solver2D(integrator);
+    solver2D.addForce(constantForce2D);
     particleManager.addRandomParticles(0.5f, particleCount);
 
 
@@ -55,8 +58,7 @@ int main() {
 
         // Rendu
         renderer.clear();
-        constantForce2D.apply(particleManager);
-        leapfrogSolver2D.solve(particleManager, dt);
+        solver2D.solve(particleManager, dt);
         particleManager.drawParticles(renderer);
 
         TwDraw();
@@ -6,6 +6,7 @@
 
 #include <PartyKel/renderer/Renderer3D.hpp>
 #include <PartyKel/renderer/TrackballCamera.hpp>
+#include <graphics/CameraUniformBuffer.h>
 
 #include <vector>
 
@@ -61,7 +62,9 @@ int main() {
     particleManager.addCircleParticles(0.5f, 128);
 
     Renderer3D renderer;
-    renderer.setProjMatrix(glm::perspective(70.f, float(WINDOW_WIDTH) / WINDOW_HEIGHT, 0.1f, 100.f));
+    glm::mat4 projection = glm::perspective(70.f, float(WINDOW_WIDTH) / WINDOW_HEIGHT, 0.1f, 100.f);
+    Graphics::CameraUniformBuffer cameraUBO;
+    renderer.setSphereMode(Renderer3D::SPHERE_IMPOSTOR);
 
     TrackballCamera camera;
     int mouseLastX, mouseLastY;
@@ -77,7 +80,7 @@ int main() {
         // Rendu
         renderer.clear();
 
-        renderer.setViewMatrix(camera.getViewMatrix());
+        cameraUBO.update(projection, camera.getViewMatrix());
         particleManager.drawParticles(renderer);
 
         // Simulation
@@ -96,6 +99,11 @@ int main() {
                     if(e.key.keysym.sym == SDLK_SPACE) {
                         wireframe = !wireframe;
                     }
+                    // Bascule entre impostors et maillage des sphères
+                    if(e.key.keysym.sym == SDLK_i) {
+                        renderer.setSphereMode(renderer.getSphereMode() == Renderer3D::SPHERE_IMPOSTOR ?
+                                               Renderer3D::SPHERE_MESH : Renderer3D::SPHERE_IMPOSTOR);
+                    }
                 case SDL_MOUSEBUTTONDOWN:
                     if(e.button.button == SDL_BUTTON_WHEELUP) {
                         camera.moveFront(0.1f);
@@ -7,7 +7,8 @@
 #include <PartyKel/atb.hpp>
 #include <PartyKel/ParticleManager2D.hpp>
 #include <PartyKel/ConstantForce2D.hpp>
-#include <PartyKel/LeapfrogSolver2D.hpp>
+#include <PartyKel/Solver2D.hpp>
+#include <PartyKel/Integrator.hpp>
 #include <PartyKel/Polygon2D.hpp>
 #include <vector>
 
@@ -32,7 +33,9 @@ int main() {
     // Création des particules
     ParticleManager2D particleManager;
     ConstantForce2D constantForce2D(glm::vec2(0, -0.01));
-    LeapfrogSolver2D leapfrogSolver2D;
+    SymplecticEulerIntegrator<glm::vec2> integrator;
+    Solver2D solver2D(integrator);
+    solver2D.addForce(constantForce2D);
     particleManager.addRandomParticles(0.5f, particleCount);
 
     Polygon2D polygon2DBox = Polygon2D::buildBox(glm::vec3(1,0,0), glm::vec2(-0.9, -0.9), 1.8, 1.8);
@@ -60,8 +63,7 @@ int main() {
         renderer.clear();
         polygon2DCircle.draw(renderer);
         polygon2DBox.draw(renderer);
-        constantForce2D.apply(particleManager);
-        leapfrogSolver2D.solve(particleManager, dt);
+        solver2D.solve(particleManager, dt);
         particleManager.drawParticles(renderer);
 
         TwDraw();